@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+
+#include "book_types.h"
+
+// Book features for each snapshot row, kept up to date from the per-level
+// deltas OrderBook applies in add_order / cancel_order instead of being
+// recomputed from the emitted levels. Every row carries:
+//
+//   microprice   (bid_px * ask_sz + ask_px * bid_sz) / (bid_sz + ask_sz)
+//   imbalance    (bid_sz - ask_sz) / (bid_sz + ask_sz), at the touch
+//   wmid         mid of the size-weighted average prices of the best 10
+//                levels of each side
+//   depth_5/10   total size of the best 5 / 10 levels, per side
+//
+// The first three need both sides; on a one-sided book they are 0.
+// Depths are counted over 5 and 10 levels whatever the output depth is.
+
+constexpr int ANALYTICS_NEAR = 5;
+constexpr int ANALYTICS_FAR = 10;
+
+struct BookFeatures {
+    bool two_sided;
+    Price microprice;
+    double imbalance;
+    Price wmid;
+    int64_t bid_depth_5;
+    int64_t ask_depth_5;
+    int64_t bid_depth_10;
+    int64_t ask_depth_10;
+};
+
+enum class LevelChange { Size, Insert, Remove };
+
+// Running totals over the best levels of one side. apply() takes a change
+// after the book has been updated: the size delta at price and whether the
+// level is new or now gone. A level entering or leaving the top shifts the
+// levels below it by one, so the one crossing the 5 / 10 boundary is looked
+// up; changes below the 10th level cost one capped rank().
+class SideAnalytics {
+public:
+    Price best_px = 0;
+    int64_t best_sz = 0; // 0: side empty
+    int64_t depth_5 = 0;
+    int64_t depth_10 = 0;
+    __int128 notional_10 = 0; // sum of px * sz over the best 10 levels
+
+    template<typename Side>
+    void apply(const Side &book, Price price, int delta, LevelChange change) {
+        int rank = book.rank(price, ANALYTICS_FAR);
+        if (rank >= ANALYTICS_FAR) return;
+
+        if (rank < ANALYTICS_NEAR) depth_5 += delta;
+        depth_10 += delta;
+        notional_10 += static_cast<__int128>(price) * delta;
+
+        if (change == LevelChange::Insert) {
+            // pushed down past the boundary
+            if (rank < ANALYTICS_NEAR) depth_5 -= level_at(book, ANALYTICS_NEAR).sz;
+            MbpLevel out = level_at(book, ANALYTICS_FAR);
+            depth_10 -= out.sz;
+            notional_10 -= static_cast<__int128>(out.px) * out.sz;
+        } else if (change == LevelChange::Remove) {
+            // pulled up across the boundary
+            if (rank < ANALYTICS_NEAR) depth_5 += level_at(book, ANALYTICS_NEAR - 1).sz;
+            MbpLevel in = level_at(book, ANALYTICS_FAR - 1);
+            depth_10 += in.sz;
+            notional_10 += static_cast<__int128>(in.px) * in.sz;
+        }
+
+        if (rank == 0) {
+            if (change == LevelChange::Size) {
+                best_sz += delta;
+            } else {
+                MbpLevel best = level_at(book, 0);
+                best_px = best.px;
+                best_sz = best.sz;
+            }
+        }
+    }
+
+    // from scratch, after the book was rebuilt without apply() (restore)
+    template<typename Side>
+    void rebuild(const Side &book) {
+        *this = SideAnalytics();
+        int rank = 0;
+        book.for_each_level(ANALYTICS_FAR, [&](Price price, const PriceLevel &level) {
+            if (rank == 0) {
+                best_px = price;
+                best_sz = level.total_size;
+            }
+            if (rank < ANALYTICS_NEAR) depth_5 += level.total_size;
+            depth_10 += level.total_size;
+            notional_10 += static_cast<__int128>(price) * level.total_size;
+            rank++;
+        });
+    }
+
+private:
+    // level at rank n, sz 0 if the side is shallower
+    template<typename Side>
+    static MbpLevel level_at(const Side &book, int n) {
+        MbpLevel found = { 0, 0, 0 };
+        int rank = 0;
+        book.for_each_level(n + 1, [&](Price price, const PriceLevel &level) {
+            if (rank++ == n) found = { price, level.total_size, level.order_count };
+        });
+        return found;
+    }
+};
+
+struct BookAnalytics {
+    SideAnalytics bid;
+    SideAnalytics ask;
+
+    BookFeatures features() const {
+        BookFeatures f = {};
+        f.bid_depth_5 = bid.depth_5;
+        f.ask_depth_5 = ask.depth_5;
+        f.bid_depth_10 = bid.depth_10;
+        f.ask_depth_10 = ask.depth_10;
+        f.two_sided = bid.best_sz > 0 && ask.best_sz > 0;
+        if (!f.two_sided) return f;
+
+        __int128 touch = bid.best_sz + ask.best_sz;
+        f.microprice = static_cast<Price>((static_cast<__int128>(bid.best_px) * ask.best_sz +
+                                           static_cast<__int128>(ask.best_px) * bid.best_sz) / touch);
+        f.imbalance = static_cast<double>(bid.best_sz - ask.best_sz) / static_cast<double>(touch);
+        f.wmid = static_cast<Price>((bid.notional_10 / bid.depth_10 + ask.notional_10 / ask.depth_10) / 2);
+        return f;
+    }
+};
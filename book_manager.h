@@ -0,0 +1,366 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "book_side.h"
+#include "mbo_parser.h"
+#include "mbp_snapshot.h"
+#include "order_book.h"
+#include "spsc_ring.h"
+
+// Multi-instrument engine. Each record is routed by instrument_id to that
+// instrument's own OrderBook; instruments are spread over N worker threads
+// (round-robin in first-seen order) and handed off through one SPSC ring per
+// shard, so every instrument's records are processed in input order.
+//
+// Output is either one file per instrument (output.csv -> output_1108.csv,
+// each shard writes its own instruments' files) or a single merged stream.
+// In merged mode workers tag every snapshot with the position of the input
+// record that produced it and a merge thread interleaves the shards by tag,
+// giving the same rows in the same order as processing the whole input on
+// one thread, independent of the thread count.
+
+enum class InstrumentOutput { Merged, PerInstrument };
+
+struct ManagerConfig {
+    int threads = 1;
+    InstrumentOutput output = InstrumentOutput::Merged;
+    std::string output_path = "output.csv";
+    size_t ring_size = 1 << 14;
+    BookConfig book;
+};
+
+// writer columns the books' own output adds (book analytics)
+inline uint32_t mbp_columns(const BookConfig &config) {
+    return config.analytics ? MBP_COLUMNS_ANALYTICS : 0;
+}
+
+// output.csv -> output_1108.csv
+inline std::string instrument_output_path(const std::string &path, uint32_t instrument_id) {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return path + "_" + std::to_string(instrument_id);
+    }
+    return path.substr(0, dot) + "_" + std::to_string(instrument_id) + path.substr(dot);
+}
+
+template<template<bool> class BookSide, typename Writer, int Depth = MBP_DEPTH>
+class BookManager {
+public:
+    explicit BookManager(const ManagerConfig &config) : config(config) {
+        int threads = config.threads > 0 ? config.threads : 1;
+        for (int i = 0; i < threads; i++) {
+            shards.push_back(std::make_unique<Shard>(config.ring_size));
+        }
+        for (auto &shard : shards) {
+            Shard *s = shard.get();
+            s->thread = std::thread([this, s] { run_shard(*s); });
+        }
+        if (config.output == InstrumentOutput::Merged) {
+            merged_writer = std::make_unique<Writer>(config.output_path, -1, Depth, mbp_columns(config.book));
+            merged_writer->write_header();
+            merge_thread = std::thread([this] { run_merge(); });
+        }
+    }
+
+    ~BookManager() {
+        if (!finished) finish();
+    }
+
+    BookManager(const BookManager &) = delete;
+    BookManager &operator=(const BookManager &) = delete;
+
+    template<typename Reader>
+    void load(Reader &reader) {
+        MboRecord rec;
+        while (reader.next(rec)) {
+            on_mbo(rec);
+        }
+        finish();
+    }
+
+    void on_mbo(const MboRecord &rec) {
+        auto it = instruments.find(rec.instrument_id);
+        if (it == instruments.end()) {
+            it = instruments.emplace(rec.instrument_id, static_cast<uint32_t>(instruments.size())).first;
+        }
+        uint32_t ordinal = it->second;
+
+        ShardMessage msg;
+        msg.kind = ShardMessage::Record;
+        msg.seq = dispatched++;
+        msg.ordinal = ordinal;
+        msg.rec = rec;
+        shards[ordinal % shards.size()]->input.push(msg);
+
+        // lets idle shards advance their watermark so the merge never stalls
+        if (dispatched % HEARTBEAT_INTERVAL == 0) {
+            broadcast(ShardMessage::Heartbeat, dispatched);
+        }
+    }
+
+    // end of input: drains every book, joins the workers, flushes output
+    void finish() {
+        if (finished) return;
+        finished = true;
+
+        broadcast(ShardMessage::End, dispatched);
+        for (auto &shard : shards) {
+            shard->thread.join();
+        }
+        if (merge_thread.joinable()) {
+            merge_thread.join();
+            merged_writer->flush();
+        }
+    }
+
+    uint64_t output_bytes() const {
+        if (merged_writer) return merged_writer->bytes_written();
+
+        uint64_t total = 0;
+        for (const auto &shard : shards) total += shard->bytes_written;
+        return total;
+    }
+
+    size_t instrument_count() const { return instruments.size(); }
+
+private:
+    static constexpr uint64_t HEARTBEAT_INTERVAL = 1024;
+    static constexpr size_t CHUNK_ROWS = 256;
+    static constexpr uint64_t END_OF_STREAM = std::numeric_limits<uint64_t>::max();
+
+    struct ShardMessage {
+        enum Kind : uint8_t { Record, Heartbeat, End };
+        Kind kind;
+        uint64_t seq;     // input position (Record) / records dispatched so far
+        uint32_t ordinal; // first-seen index of the instrument
+        MboRecord rec;
+    };
+
+    // snapshot plus a private copy of the record it points to
+    struct TaggedSnapshot {
+        uint64_t tag;
+        MboRecord rec;
+        MbpSnapshot<Depth> snap;
+    };
+
+    // all rows tagged below watermark are in this or an earlier chunk
+    struct OutputChunk {
+        std::vector<TaggedSnapshot> rows;
+        uint64_t watermark;
+    };
+
+    // Writer stand-in for books in merged mode, queues snapshots for the merge
+    struct SnapshotCollector {
+        uint64_t tag = 0;
+        std::vector<TaggedSnapshot> pending;
+
+        void write_row(const MbpSnapshot<Depth> &snap) {
+            pending.push_back({ tag, *snap.rec, snap });
+        }
+    };
+
+    using MergedBook = OrderBook<BookSide, SnapshotCollector, Depth>;
+
+    // per-instrument mode: each book owns its file
+    struct SplitBook {
+        Writer writer;
+        OrderBook<BookSide, Writer, Depth> book;
+
+        SplitBook(const std::string &path, const BookConfig &config)
+            : writer(path, -1, Depth, mbp_columns(config)), book(writer, config) {
+            writer.write_header();
+        }
+    };
+
+    struct Shard {
+        explicit Shard(size_t ring_size) : input(ring_size) {}
+
+        SpscRing<ShardMessage> input;
+        std::thread thread;
+        uint64_t bytes_written = 0;
+
+        // merged mode hand-off to the merge thread, guarded by output_mutex
+        std::deque<OutputChunk> chunks;
+    };
+
+    ManagerConfig config;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::unordered_map<uint32_t, uint32_t> instruments; // instrument_id -> ordinal
+    uint64_t dispatched = 0;
+    bool finished = false;
+
+    std::unique_ptr<Writer> merged_writer;
+    std::thread merge_thread;
+    std::mutex output_mutex;
+    std::condition_variable output_ready;
+    uint64_t chunks_published = 0;
+
+    void broadcast(typename ShardMessage::Kind kind, uint64_t seq) {
+        ShardMessage msg;
+        msg.kind = kind;
+        msg.seq = seq;
+        msg.ordinal = 0;
+        for (auto &shard : shards) {
+            shard->input.push(msg);
+        }
+    }
+
+    void publish(Shard &shard, SnapshotCollector &collector, uint64_t watermark) {
+        OutputChunk chunk;
+        chunk.rows.swap(collector.pending);
+        chunk.watermark = watermark;
+        {
+            std::lock_guard<std::mutex> lock(output_mutex);
+            shard.chunks.push_back(std::move(chunk));
+            chunks_published++;
+        }
+        output_ready.notify_one();
+    }
+
+    void run_shard(Shard &shard) {
+        if (config.output == InstrumentOutput::Merged) {
+            run_merged_shard(shard);
+        } else {
+            run_split_shard(shard);
+        }
+    }
+
+    void run_merged_shard(Shard &shard) {
+        SnapshotCollector collector;
+        std::unordered_map<uint32_t, std::unique_ptr<MergedBook>> books;
+        std::vector<std::pair<uint32_t, MergedBook *>> by_ordinal; // creation order
+        ShardMessage msg;
+
+        while (true) {
+            shard.input.pop(msg);
+
+            if (msg.kind == ShardMessage::Record) {
+                auto it = books.find(msg.rec.instrument_id);
+                if (it == books.end()) {
+                    it = books.emplace(msg.rec.instrument_id, std::make_unique<MergedBook>(collector, config.book)).first;
+                    by_ordinal.emplace_back(msg.ordinal, it->second.get());
+                }
+                collector.tag = msg.seq;
+                it->second->on_mbo(msg.rec);
+
+                if (collector.pending.size() >= CHUNK_ROWS) {
+                    publish(shard, collector, msg.seq + 1);
+                }
+            } else if (msg.kind == ShardMessage::Heartbeat) {
+                publish(shard, collector, msg.seq);
+            } else {
+                // EOF drains sort after every input record, by instrument first-seen order
+                for (auto &[ordinal, book] : by_ordinal) {
+                    collector.tag = msg.seq + ordinal;
+                    book->finish();
+                }
+                publish(shard, collector, END_OF_STREAM);
+                return;
+            }
+        }
+    }
+
+    void run_split_shard(Shard &shard) {
+        std::unordered_map<uint32_t, std::unique_ptr<SplitBook>> books;
+        ShardMessage msg;
+
+        while (true) {
+            shard.input.pop(msg);
+
+            if (msg.kind == ShardMessage::Record) {
+                auto it = books.find(msg.rec.instrument_id);
+                if (it == books.end()) {
+                    std::string path = instrument_output_path(config.output_path, msg.rec.instrument_id);
+                    it = books.emplace(msg.rec.instrument_id, std::make_unique<SplitBook>(path, config.book)).first;
+                }
+                it->second->book.on_mbo(msg.rec);
+            } else if (msg.kind == ShardMessage::End) {
+                for (auto &[id, split] : books) {
+                    split->book.finish();
+                    split->writer.flush();
+                    shard.bytes_written += split->writer.bytes_written();
+                }
+                return;
+            }
+        }
+    }
+
+    void run_merge() {
+        struct Cursor {
+            OutputChunk chunk;
+            size_t pos = 0;
+            uint64_t watermark = 0;
+        };
+        std::vector<Cursor> cursors(shards.size());
+        uint64_t seen = 0;
+        int row_index = 0;
+
+        std::unique_lock<std::mutex> lock(output_mutex);
+        while (true) {
+            // pull the next chunk of every shard whose current one is used up
+            for (size_t s = 0; s < shards.size(); s++) {
+                Cursor &c = cursors[s];
+                while (c.pos == c.chunk.rows.size() && !shards[s]->chunks.empty()) {
+                    c.chunk = std::move(shards[s]->chunks.front());
+                    shards[s]->chunks.pop_front();
+                    c.pos = 0;
+                    c.watermark = c.chunk.watermark;
+                }
+            }
+            seen = chunks_published;
+
+            // smallest pending tag wins if no other shard can still produce a smaller one
+            size_t best = shards.size();
+            for (size_t s = 0; s < shards.size(); s++) {
+                const Cursor &c = cursors[s];
+                if (c.pos < c.chunk.rows.size() &&
+                    (best == shards.size() || c.chunk.rows[c.pos].tag < cursors[best].chunk.rows[cursors[best].pos].tag)) {
+                    best = s;
+                }
+            }
+
+            bool all_done = true;
+            for (const Cursor &c : cursors) {
+                all_done = all_done && c.watermark == END_OF_STREAM;
+            }
+            if (best == shards.size() && all_done) break;
+
+            bool ready = best != shards.size();
+            if (ready) {
+                uint64_t tag = cursors[best].chunk.rows[cursors[best].pos].tag;
+                for (size_t s = 0; s < shards.size() && ready; s++) {
+                    const Cursor &c = cursors[s];
+                    if (s != best && c.pos == c.chunk.rows.size() && c.watermark <= tag) {
+                        ready = false;
+                    }
+                }
+            }
+
+            if (!ready) {
+                output_ready.wait(lock, [&] { return chunks_published != seen; });
+                continue;
+            }
+
+            // formatting happens outside the lock so workers can keep publishing
+            lock.unlock();
+            Cursor &c = cursors[best];
+            TaggedSnapshot &row = c.chunk.rows[c.pos++];
+            row.snap.rec = &row.rec;
+            row.snap.row_index = row_index++;
+            merged_writer->write_row(row.snap);
+            lock.lock();
+        }
+    }
+};
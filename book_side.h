@@ -0,0 +1,272 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+#include "book_types.h"
+
+// One side of the book, keyed by price. Two interchangeable backends share
+// this interface so OrderBook can be built on either:
+//
+//   get_or_create(px)    level at px, created empty if missing
+//   find(px)             level at px or nullptr
+//   erase(px)            drop the (empty) level at px
+//   rank(px, limit)      number of levels strictly better than px, capped
+//   in_top_n(px, n)      px is a live level among the first n levels
+//   for_each_level(n,f)  f(px, level) for the n best levels, best first
+//
+// IsBid selects the ordering: bids best = highest, asks best = lowest.
+
+// Rows are emitted when a change touches one of the first top_n_levels(Depth)
+// levels of a side. That is exactly Depth, except at MBP-10: the original
+// price_in_top_n loop checked the first 11 levels, so a change at level 11
+// also emits an (unchanged) row, and MBP-10 output keeps that for byte
+// compatibility with the reference mbp.csv.
+constexpr int top_n_levels(int depth) {
+    return depth == 10 ? depth + 1 : depth;
+}
+
+struct BookConfig {
+    Price tick_size = PRICE_SCALE / 100; // 0.01
+    int ladder_window = 4096;            // ticks held in the dense ladder
+    size_t order_capacity = 0;           // expected live orders, pre-sizes the order table
+    bool analytics = false;              // keep BookFeatures for every row (book_analytics.h)
+};
+
+// std::map backed side, the original representation.
+template<bool IsBid>
+class MapBookSide {
+public:
+    using Better = std::conditional_t<IsBid, std::greater<>, std::less<>>;
+
+    explicit MapBookSide(const BookConfig & = BookConfig()) {}
+
+    PriceLevel &get_or_create(Price price) { return levels[price]; }
+
+    PriceLevel *find(Price price) {
+        auto it = levels.find(price);
+        return it == levels.end() ? nullptr : &it->second;
+    }
+
+    void erase(Price price) { levels.erase(price); }
+
+    bool empty() const { return levels.empty(); }
+
+    int rank(Price price, int limit = INT_MAX) const {
+        int depth = 0;
+        for (auto it = levels.begin(); it != levels.end() && depth < limit && Better()(it->first, price); ++it) {
+            depth++;
+        }
+        return depth;
+    }
+
+    bool in_top_n(Price price, int n) const {
+        int count = 0;
+        for (const auto& [p, _] : levels) {
+            if (count++ >= n) break;
+            if (p == price) return true;
+        }
+        return false;
+    }
+
+    template<typename Fn>
+    void for_each_level(int n, Fn fn) const {
+        for (auto it = levels.begin(); it != levels.end() && n > 0; ++it, --n) {
+            fn(it->first, it->second);
+        }
+    }
+
+private:
+    std::map<Price, PriceLevel, Better> levels;
+};
+
+// Dense ladder: a contiguous array of levels indexed by tick distance from a
+// re-centerable anchor, plus a bitmap of non-empty slots. Slots are stored in
+// "best first" order (pos 0 is the best price the window can hold), so rank
+// and top-N checks are popcounts over a few words starting at the cached best
+// slot. Off-grid prices and prices outside the window fall back to a std::map.
+template<bool IsBid>
+class LadderBookSide {
+public:
+    using Better = std::conditional_t<IsBid, std::greater<>, std::less<>>;
+
+    explicit LadderBookSide(const BookConfig &config = BookConfig())
+        : tick_size(config.tick_size),
+          window(((config.ladder_window + 63) / 64) * 64),
+          levels(window),
+          bits(window / 64, 0),
+          best_pos(window) {}
+
+    PriceLevel &get_or_create(Price price) {
+        int pos = pos_of(price);
+        if (pos < 0 && on_grid(price) && (live_slots == 0 || better_than_window(price))) {
+            // touch moved past the window (or the window is empty): re-anchor on it
+            recenter(price / tick_size);
+            pos = pos_of(price);
+        }
+        if (pos < 0) return overflow[price];
+
+        if (!test(pos)) {
+            levels[pos] = PriceLevel();
+            set(pos);
+        }
+        return levels[pos];
+    }
+
+    PriceLevel *find(Price price) {
+        int pos = pos_of(price);
+        if (pos >= 0) return test(pos) ? &levels[pos] : nullptr;
+
+        auto it = overflow.find(price);
+        return it == overflow.end() ? nullptr : &it->second;
+    }
+
+    void erase(Price price) {
+        int pos = pos_of(price);
+        if (pos < 0) {
+            overflow.erase(price);
+            return;
+        }
+        clear(pos);
+
+        // window drained while the book lives on in the overflow map
+        if (live_slots == 0 && !overflow.empty() && on_grid(overflow.begin()->first)) {
+            recenter(overflow.begin()->first / tick_size);
+        }
+    }
+
+    bool empty() const { return live_slots == 0 && overflow.empty(); }
+
+    int rank(Price price, int limit = INT_MAX) const {
+        int depth = count_window_better(price, limit);
+        for (auto it = overflow.begin(); it != overflow.end() && depth < limit && Better()(it->first, price); ++it) {
+            depth++;
+        }
+        return depth;
+    }
+
+    bool in_top_n(Price price, int n) const {
+        int pos = pos_of(price);
+        bool live = pos >= 0 ? test(pos) : overflow.count(price) != 0;
+        return live && rank(price, n) < n;
+    }
+
+    template<typename Fn>
+    void for_each_level(int n, Fn fn) const {
+        int pos = next_set(best_pos);
+        auto ov = overflow.begin();
+
+        while (n > 0 && (pos < window || ov != overflow.end())) {
+            bool take_window = pos < window &&
+                (ov == overflow.end() || Better()(price_at(pos), ov->first));
+            if (take_window) {
+                fn(price_at(pos), levels[pos]);
+                pos = next_set(pos + 1);
+            } else {
+                fn(ov->first, ov->second);
+                ++ov;
+            }
+            n--;
+        }
+    }
+
+private:
+    Price tick_size;
+    int window;
+    int64_t anchor_tick = 0; // tick held by pos 0
+    std::vector<PriceLevel> levels;
+    std::vector<uint64_t> bits;
+    int best_pos;
+    int live_slots = 0;
+    std::map<Price, PriceLevel, Better> overflow;
+
+    static constexpr int64_t direction = IsBid ? -1 : 1;
+
+    bool on_grid(Price price) const { return price % tick_size == 0; }
+
+    Price price_at(int pos) const { return (anchor_tick + direction * pos) * tick_size; }
+
+    int pos_of(Price price) const {
+        if (!on_grid(price)) return -1;
+        int64_t pos = (price / tick_size - anchor_tick) * direction;
+        return (pos >= 0 && pos < window) ? static_cast<int>(pos) : -1;
+    }
+
+    bool better_than_window(Price price) const { return Better()(price, price_at(0)); }
+
+    bool test(int pos) const { return (bits[pos >> 6] >> (pos & 63)) & 1; }
+
+    void set(int pos) {
+        bits[pos >> 6] |= uint64_t(1) << (pos & 63);
+        live_slots++;
+        if (pos < best_pos) best_pos = pos;
+    }
+
+    void clear(int pos) {
+        bits[pos >> 6] &= ~(uint64_t(1) << (pos & 63));
+        live_slots--;
+        if (pos == best_pos) best_pos = next_set(pos + 1);
+    }
+
+    // first non-empty slot at or after pos, window if none
+    int next_set(int pos) const {
+        if (pos >= window) return window;
+        int word = pos >> 6;
+        uint64_t w = bits[word] & (~uint64_t(0) << (pos & 63));
+        while (true) {
+            if (w) return (word << 6) + __builtin_ctzll(w);
+            if (++word >= window / 64) return window;
+            w = bits[word];
+        }
+    }
+
+    // number of live window slots strictly better than price, capped at limit
+    int count_window_better(Price price, int limit) const {
+        // slots [0, bound) hold prices strictly better than price
+        int64_t ticks_floor = price / tick_size - (price % tick_size < 0 ? 1 : 0);
+        int64_t ticks_ceil = ticks_floor + (price % tick_size != 0 ? 1 : 0);
+        int64_t bound = IsBid ? anchor_tick - ticks_floor : ticks_ceil - anchor_tick;
+        if (bound > window) bound = window;
+        if (bound <= best_pos) return 0;
+
+        int count = 0;
+        int last_word = static_cast<int>((bound - 1) >> 6);
+        for (int word = best_pos >> 6; word <= last_word && count < limit; word++) {
+            uint64_t w = bits[word];
+            if (word == last_word && (bound & 63)) {
+                w &= (uint64_t(1) << (bound & 63)) - 1;
+            }
+            count += __builtin_popcountll(w);
+        }
+        return count < limit ? count : limit;
+    }
+
+    // moves the window so tick sits in its middle, swapping levels with the
+    // overflow map as needed. O(levels), only runs when the touch escapes.
+    void recenter(int64_t tick) {
+        for (int pos = next_set(best_pos); pos < window; pos = next_set(pos + 1)) {
+            overflow.emplace(price_at(pos), levels[pos]);
+        }
+        std::fill(bits.begin(), bits.end(), 0);
+        live_slots = 0;
+        best_pos = window;
+
+        anchor_tick = tick - direction * (window / 2);
+
+        for (auto it = overflow.begin(); it != overflow.end();) {
+            int pos = pos_of(it->first);
+            if (pos >= 0) {
+                levels[pos] = it->second;
+                set(pos);
+                it = overflow.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "price.h"
+
+// pool index meaning "no order" (end of a level queue)
+constexpr uint32_t NO_ORDER = UINT32_MAX;
+
+// Resting order. prev/next link it into its price level's FIFO queue, so the
+// queue is an intrusive list over the pool and unlinking is O(1).
+struct Order {
+    uint64_t order_id;
+    char side; // 'B' for Bid, 'A' for Ask
+    Price price;
+    int size;
+    uint32_t prev = NO_ORDER;
+    uint32_t next = NO_ORDER;
+};
+
+// One price level: head/tail of its order queue (oldest first) plus running
+// totals, so snapshots never walk the queue.
+struct PriceLevel {
+    uint32_t head = NO_ORDER;
+    uint32_t tail = NO_ORDER;
+    int total_size = 0;
+    int order_count = 0;
+};
+
+// One visible level of an MBP snapshot.
+struct MbpLevel {
+    Price px;
+    int sz;
+    int ct;
+};
+
+// Contiguous order storage. Released slots go on a free list and are reused,
+// so steady-state add/cancel flow does not allocate.
+class OrderPool {
+public:
+    uint32_t allocate(const Order &order) {
+        if (!free_slots.empty()) {
+            uint32_t index = free_slots.back();
+            free_slots.pop_back();
+            slots[index] = order;
+            return index;
+        }
+        slots.push_back(order);
+        return static_cast<uint32_t>(slots.size() - 1);
+    }
+
+    void release(uint32_t index) { free_slots.push_back(index); }
+
+    void reserve(size_t n) { slots.reserve(n); }
+
+    Order &operator[](uint32_t index) { return slots[index]; }
+    const Order &operator[](uint32_t index) const { return slots[index]; }
+
+private:
+    std::vector<Order> slots;
+    std::vector<uint32_t> free_slots;
+};
@@ -0,0 +1,156 @@
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "mbo_binary.h"
+
+volatile std::sig_atomic_t checkpoint_requested = 0;
+
+static void on_checkpoint_signal(int) {
+    checkpoint_requested = 1;
+}
+
+void install_checkpoint_signal() {
+    std::signal(SIGUSR1, on_checkpoint_signal);
+}
+
+std::string encode_checkpoint(const Checkpoint &checkpoint) {
+    const BookState &book = checkpoint.book;
+
+    CheckpointHeader header = {};
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.price_scale_digits = PRICE_SCALE_DIGITS;
+    header.input_format = static_cast<uint32_t>(checkpoint.input_format);
+    header.output_format = static_cast<uint32_t>(checkpoint.output_format);
+    header.input_size = checkpoint.input_size;
+    header.input_offset = checkpoint.input_offset;
+    header.output_offset = checkpoint.output_offset;
+    header.records_read = checkpoint.records_read;
+    header.last_ts_event = checkpoint.last_ts_event;
+    header.last_sequence = checkpoint.last_sequence;
+    header.row_index = book.row_index;
+    header.order_count = book.orders.size();
+    header.pending_count = static_cast<uint32_t>(book.pending.size());
+    header.depth = static_cast<uint32_t>(checkpoint.depth);
+
+    std::vector<MboBinaryRecord> records;
+    std::vector<MboBinarySymbol> symbols;
+    for (const MboRecord &rec : book.pending) {
+        // full width, no terminator (read back with strnlen); a cut name
+        // would restore the row under another symbol
+        MboBinarySymbol symbol = {};
+        if (rec.symbol.size() > sizeof(symbol.name)) {
+            throw std::runtime_error("checkpoint: symbol " + std::string(rec.symbol) + " is longer than " +
+                                     std::to_string(sizeof(symbol.name)) + " bytes");
+        }
+        std::memcpy(symbol.name, rec.symbol.data(), rec.symbol.size());
+        records.push_back(encode_binary_record(rec, static_cast<uint16_t>(symbols.size())));
+        symbols.push_back(symbol);
+    }
+
+    std::string data;
+    data.reserve(sizeof(header) + book.orders.size() * sizeof(CheckpointOrder) +
+                 records.size() * (sizeof(MboBinaryRecord) + sizeof(MboBinarySymbol)));
+    data.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    data.append(reinterpret_cast<const char *>(book.orders.data()), book.orders.size() * sizeof(CheckpointOrder));
+    data.append(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(MboBinaryRecord));
+    data.append(reinterpret_cast<const char *>(symbols.data()), symbols.size() * sizeof(MboBinarySymbol));
+    return data;
+}
+
+void decode_checkpoint(std::string_view data, Checkpoint &checkpoint, const std::string &what) {
+    CheckpointHeader header;
+    if (data.size() < sizeof(header)) {
+        throw std::runtime_error(what + ": not a checkpoint (version " + std::to_string(CHECKPOINT_VERSION) + ")");
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 || header.version != CHECKPOINT_VERSION) {
+        throw std::runtime_error(what + ": not a checkpoint (version " + std::to_string(CHECKPOINT_VERSION) + ")");
+    }
+    if (header.price_scale_digits != PRICE_SCALE_DIGITS) {
+        throw std::runtime_error(what + ": price scale mismatch, checkpoint uses " +
+                                 std::to_string(header.price_scale_digits) + " digits");
+    }
+
+    size_t orders_size = header.order_count * sizeof(CheckpointOrder);
+    size_t pending_size = header.pending_count * (sizeof(MboBinaryRecord) + sizeof(MboBinarySymbol));
+    if (header.order_count > data.size() || data.size() != sizeof(header) + orders_size + pending_size) {
+        throw std::runtime_error(what + ": truncated or corrupt checkpoint");
+    }
+
+    const char *p = data.data() + sizeof(header);
+    BookState &book = checkpoint.book;
+    book.row_index = header.row_index;
+    book.orders.resize(header.order_count);
+    std::memcpy(book.orders.data(), p, orders_size);
+    p += orders_size;
+
+    std::vector<MboBinaryRecord> records(header.pending_count);
+    std::vector<MboBinarySymbol> symbols(header.pending_count);
+    std::memcpy(records.data(), p, records.size() * sizeof(MboBinaryRecord));
+    p += records.size() * sizeof(MboBinaryRecord);
+    std::memcpy(symbols.data(), p, symbols.size() * sizeof(MboBinarySymbol));
+
+    checkpoint.input_format = static_cast<CheckpointInput>(header.input_format);
+    checkpoint.output_format = static_cast<CheckpointOutput>(header.output_format);
+    checkpoint.input_size = header.input_size;
+    checkpoint.input_offset = header.input_offset;
+    checkpoint.output_offset = header.output_offset;
+    checkpoint.records_read = header.records_read;
+    checkpoint.last_ts_event = header.last_ts_event;
+    checkpoint.last_sequence = header.last_sequence;
+    checkpoint.depth = static_cast<int>(header.depth);
+
+    checkpoint.symbols.clear();
+    book.pending.resize(records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        const char *name = symbols[i].name;
+        checkpoint.symbols.emplace_back(name, strnlen(name, sizeof(MboBinarySymbol::name)));
+        decode_binary_record(records[i], checkpoint.symbols.back(), book.pending[i]);
+    }
+}
+
+void write_checkpoint(const std::string &path, const Checkpoint &checkpoint) {
+    std::string data = encode_checkpoint(checkpoint);
+
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), data.size());
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("cannot write checkpoint " + tmp);
+        }
+    }
+
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("cannot rename " + tmp + " to " + path);
+    }
+}
+
+void read_checkpoint(const std::string &path, Checkpoint &checkpoint) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot open checkpoint " + path);
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    decode_checkpoint(data, checkpoint, path);
+}
+
+void check_restore(const Checkpoint &checkpoint, CheckpointInput input_format, uint64_t input_size,
+                   CheckpointOutput output_format, int depth) {
+    if (checkpoint.input_format != input_format || checkpoint.input_size != input_size) {
+        throw std::runtime_error("checkpoint was taken on a different input");
+    }
+    if (checkpoint.output_format != output_format) {
+        throw std::runtime_error("checkpoint was taken with a different --output-format");
+    }
+    if (checkpoint.depth != depth) {
+        throw std::runtime_error("checkpoint was taken with --depth " + std::to_string(checkpoint.depth));
+    }
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mbo_parser.h"
+#include "mbp_snapshot.h"
+
+// Book checkpoint file layout (little-endian, same convention as the binary
+// MBO input):
+//
+//   CheckpointHeader
+//   CheckpointOrder x order_count       resting orders, bids best level first
+//                                       then asks, each level in queue order
+//   MboBinaryRecord x pending_count     rows held for T-F-C matching
+//   MboBinarySymbol x pending_count     their symbols
+//
+// Replaying the orders in file order through add_to_level rebuilds every
+// level with the same queue priority. input_offset is the byte position in
+// the input of the first record not yet applied, output_offset the size of
+// the output at that point; restore cuts the output back to it and resumes.
+
+constexpr char CHECKPOINT_MAGIC[8] = { 'M', 'B', 'O', 'C', 'K', 'P', 'T', '1' };
+constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+enum class CheckpointInput : uint32_t { Csv = 0, Binary = 1 };
+enum class CheckpointOutput : uint32_t { Csv = 0, Columnar = 1, Delta = 2 };
+
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t price_scale_digits;
+    uint32_t input_format;   // CheckpointInput
+    uint32_t output_format;  // CheckpointOutput
+    uint64_t input_size;     // bytes, to catch restoring against another file
+    uint64_t input_offset;
+    uint64_t output_offset;
+    uint64_t records_read;
+    int64_t last_ts_event;   // of the last applied record
+    uint32_t last_sequence;
+    int32_t row_index;       // next output row number
+    uint64_t order_count;
+    uint32_t pending_count;
+    uint32_t depth;          // MBP depth of the output
+};
+static_assert(sizeof(CheckpointHeader) == 88, "CheckpointHeader layout");
+
+struct CheckpointOrder {
+    uint64_t order_id;
+    int64_t price;
+    int32_t size;
+    uint8_t side;
+    uint8_t reserved[3];
+};
+static_assert(sizeof(CheckpointOrder) == 24, "CheckpointOrder layout");
+
+// What OrderBook::save() fills in and OrderBook::restore() reads back.
+struct BookState {
+    int row_index = 0;
+    std::vector<CheckpointOrder> orders;
+    std::vector<MboRecord> pending;
+};
+
+struct Checkpoint {
+    CheckpointInput input_format = CheckpointInput::Csv;
+    CheckpointOutput output_format = CheckpointOutput::Csv;
+    uint64_t input_size = 0;
+    uint64_t input_offset = 0;
+    uint64_t output_offset = 0;
+    uint64_t records_read = 0;
+    int64_t last_ts_event = 0;
+    uint32_t last_sequence = 0;
+    int depth = MBP_DEPTH;
+    BookState book;
+    std::deque<std::string> symbols; // backs book.pending[i].symbol after a read
+};
+
+// The checkpoint file contents, also embedded in replay indexes
+// (replay_index.h). decode_checkpoint throws, naming what, on bad data;
+// pending symbols are copied into checkpoint.symbols.
+std::string encode_checkpoint(const Checkpoint &checkpoint);
+void decode_checkpoint(std::string_view data, Checkpoint &checkpoint, const std::string &what);
+
+// Writes path + ".tmp" and renames it over path, so a crash mid-write leaves
+// the previous checkpoint intact. Throws on failure.
+void write_checkpoint(const std::string &path, const Checkpoint &checkpoint);
+
+// Loads and validates a checkpoint. Throws on failure.
+void read_checkpoint(const std::string &path, Checkpoint &checkpoint);
+
+// Throws unless checkpoint was taken on this input, output format and depth;
+// call before the output is reopened at checkpoint.output_offset.
+void check_restore(const Checkpoint &checkpoint, CheckpointInput input_format, uint64_t input_size,
+                   CheckpointOutput output_format, int depth);
+
+struct CheckpointConfig {
+    std::string save_path;     // empty: never checkpoint
+    uint64_t every = 0;        // records between checkpoints, 0: only on SIGUSR1 / at the end
+    std::string restore_path;  // empty: start from an empty book
+};
+
+// Set by SIGUSR1 once install_checkpoint_signal() ran; the driver writes a
+// checkpoint at the next record boundary and clears it.
+extern volatile std::sig_atomic_t checkpoint_requested;
+void install_checkpoint_signal();
+
+// Single-book driver with checkpointing. Reader needs next(), offset(),
+// seek() and bytes() (MboParser, MboBinaryReader); Writer needs flush() and
+// bytes_written() on top of write_row(). With a restore (already passed
+// through check_restore), the book and reader are moved to the checkpoint and
+// the output must have been reopened at checkpoint.output_offset. A final checkpoint is written at end
+// of input, before the T-F-C buffer is drained.
+template<typename Book, typename Reader, typename Writer>
+void run_checkpointed(Book &book, Reader &reader, Writer &output, const CheckpointConfig &config,
+                      CheckpointInput input_format, CheckpointOutput output_format,
+                      const Checkpoint *restore, std::ostream &log) {
+    Checkpoint cp;
+    cp.input_format = input_format;
+    cp.output_format = output_format;
+    cp.input_size = reader.bytes();
+    cp.depth = Book::BOOK_DEPTH;
+
+    if (restore) {
+        book.restore(restore->book);
+        reader.seek(restore->input_offset);
+        cp.records_read = restore->records_read;
+        cp.last_ts_event = restore->last_ts_event;
+        cp.last_sequence = restore->last_sequence;
+        log << "Restored checkpoint: " << restore->book.orders.size() << " orders, "
+            << restore->records_read << " records, sequence " << restore->last_sequence << std::endl;
+    }
+
+    auto save = [&]() {
+        output.flush();
+        cp.input_offset = reader.offset();
+        cp.output_offset = output.bytes_written();
+        book.save(cp.book);
+        write_checkpoint(config.save_path, cp);
+    };
+
+    bool saving = !config.save_path.empty();
+    uint64_t next_save = config.every > 0 ? cp.records_read + config.every : UINT64_MAX;
+
+    MboRecord rec;
+    while (reader.next(rec)) {
+        book.on_mbo(rec);
+        cp.records_read++;
+        cp.last_ts_event = rec.ts_event;
+        cp.last_sequence = rec.sequence;
+
+        if (saving && (cp.records_read >= next_save || checkpoint_requested)) {
+            checkpoint_requested = 0;
+            save();
+            if (config.every > 0) next_save = cp.records_read + config.every;
+        }
+    }
+
+    if (saving) save();
+    book.finish();
+}
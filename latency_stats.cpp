@@ -0,0 +1,108 @@
+#include "latency_stats.h"
+
+#ifdef LATENCY_STATS
+
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+
+// stats of threads that have exited
+static std::mutex merged_mutex;
+static LatencyStats merged_stats;
+
+// tick -> ns calibration point, taken at startup
+static const uint64_t start_ticks = latency_now();
+static const auto start_time = std::chrono::steady_clock::now();
+
+static const char *const KIND_NAMES[] = { "A", "C", "T", "F", "R", "other", "T-F-C", "snapshot" };
+
+// per-thread set, handed to merged_stats when its thread exits
+struct ThreadLatencyStats {
+    LatencyStats stats;
+
+    ~ThreadLatencyStats() {
+        std::lock_guard<std::mutex> lock(merged_mutex);
+        merged_stats.merge(stats);
+    }
+};
+
+void LatencyStats::merge(const LatencyStats &other) {
+    for (int k = 0; k < static_cast<int>(LatencyKind::Count); k++) {
+        for (int e = 0; e < 2; e++) {
+            histograms[k][e].merge(other.histograms[k][e]);
+        }
+    }
+}
+
+LatencyStats &thread_latency_stats() {
+    thread_local ThreadLatencyStats local;
+    return local.stats;
+}
+
+// finished threads plus the calling one
+static LatencyStats collect() {
+    LatencyStats all;
+    {
+        std::lock_guard<std::mutex> lock(merged_mutex);
+        all.merge(merged_stats);
+    }
+    all.merge(thread_latency_stats());
+    return all;
+}
+
+static double ns_per_tick() {
+#if defined(__x86_64__) || defined(__i386__)
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time).count();
+    uint64_t ticks = latency_now() - start_ticks;
+    return ticks > 0 ? ns / static_cast<double>(ticks) : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+bool latency_stats_enabled() { return true; }
+
+void print_latency_stats(std::ostream &out) {
+    LatencyStats all = collect();
+    double scale = ns_per_tick();
+
+    out << "Latency (ns)            count        p50        p99      p99.9        max" << std::endl;
+    for (int k = 0; k < static_cast<int>(LatencyKind::Count); k++) {
+        for (int e = 0; e < 2; e++) {
+            const LatencyHistogram &h = all.histograms[k][e];
+            if (h.count() == 0) continue;
+
+            auto ns = [&](uint64_t ticks) { return static_cast<uint64_t>(ticks * scale); };
+            out << "  " << std::left << std::setw(9) << KIND_NAMES[k] << std::setw(6) << (e ? "snap" : "-")
+                << std::right << std::setw(11) << h.count()
+                << std::setw(11) << ns(h.percentile(0.50)) << std::setw(11) << ns(h.percentile(0.99))
+                << std::setw(11) << ns(h.percentile(0.999)) << std::setw(11) << ns(h.max()) << std::endl;
+        }
+    }
+}
+
+bool dump_latency_stats(const std::string &path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+
+    LatencyStats all = collect();
+    double scale = ns_per_tick();
+
+    out << "kind,snapshot,value_ns,count\n";
+    for (int k = 0; k < static_cast<int>(LatencyKind::Count); k++) {
+        for (int e = 0; e < 2; e++) {
+            all.histograms[k][e].for_each_bucket([&](uint64_t ticks, uint64_t count) {
+                out << KIND_NAMES[k] << ',' << e << ',' << static_cast<uint64_t>(ticks * scale) << ',' << count << '\n';
+            });
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+#else
+
+bool latency_stats_enabled() { return false; }
+void print_latency_stats(std::ostream &) {}
+bool dump_latency_stats(const std::string &) { return false; }
+
+#endif
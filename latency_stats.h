@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Per-event latency instrumentation, compiled in with -DLATENCY_STATS
+// (`make latency`). LATENCY_SCOPE(kind, row_index) times the enclosing block
+// and files it under kind and under whether row_index moved, i.e. whether a
+// snapshot row was emitted. Without LATENCY_STATS the macro is empty and
+// nothing below is referenced.
+
+enum class LatencyKind : uint8_t {
+    Add,           // process_row by action
+    Cancel,
+    Trade,
+    Fill,
+    Clear,
+    Other,
+    TradeSequence, // one F-C pair of a T-F-C sweep, includes its cancel
+    Snapshot,      // get_snapshot
+    Count
+};
+
+inline LatencyKind latency_kind(char action) {
+    switch (action) {
+        case 'A': return LatencyKind::Add;
+        case 'C': return LatencyKind::Cancel;
+        case 'T': return LatencyKind::Trade;
+        case 'F': return LatencyKind::Fill;
+        case 'R': return LatencyKind::Clear;
+        default: return LatencyKind::Other;
+    }
+}
+
+#ifdef LATENCY_STATS
+
+#include <chrono>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// raw timestamps: TSC on x86, steady_clock ns elsewhere
+inline uint64_t latency_now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// HDR-style log-linear histogram: values below 2^SUB_BITS are exact, above
+// that every power of two is split into 2^(SUB_BITS-1) buckets (<1% error).
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 8;
+    static constexpr uint64_t HALF = uint64_t(1) << (SUB_BITS - 1);
+    static constexpr int MAX_BITS = 48; // larger values are clamped
+
+    LatencyHistogram() : counts(bucket_index((uint64_t(1) << MAX_BITS) - 1) + 1, 0) {}
+
+    void record(uint64_t value) {
+        if (value >= (uint64_t(1) << MAX_BITS)) value = (uint64_t(1) << MAX_BITS) - 1;
+        counts[bucket_index(value)]++;
+        total++;
+        if (value > max_value) max_value = value;
+    }
+
+    void merge(const LatencyHistogram &other) {
+        for (size_t i = 0; i < counts.size(); i++) counts[i] += other.counts[i];
+        total += other.total;
+        if (other.max_value > max_value) max_value = other.max_value;
+    }
+
+    // highest value equivalent to the q-quantile bucket, capped at max()
+    uint64_t percentile(double q) const {
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(q * total + 0.5);
+        if (rank == 0) rank = 1;
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                uint64_t upper = bucket_upper(i);
+                return upper < max_value ? upper : max_value;
+            }
+        }
+        return max_value;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return max_value; }
+
+    // calls fn(bucket upper bound, count) for every non-empty bucket
+    template<typename Fn>
+    void for_each_bucket(Fn fn) const {
+        for (size_t i = 0; i < counts.size(); i++) {
+            if (counts[i]) fn(bucket_upper(i), counts[i]);
+        }
+    }
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t max_value = 0;
+
+    static size_t bucket_index(uint64_t v) {
+        if (v < 2 * HALF) return static_cast<size_t>(v);
+        int shift = 63 - __builtin_clzll(v) - SUB_BITS + 1;
+        return static_cast<size_t>(shift * HALF + (v >> shift));
+    }
+
+    static uint64_t bucket_upper(size_t index) {
+        if (index < 2 * HALF) return index;
+        uint64_t shift = index / HALF - 1;
+        uint64_t sub = index - shift * HALF;
+        return ((sub + 1) << shift) - 1;
+    }
+};
+
+// One histogram per kind and snapshot/no-snapshot. Each thread records into
+// its own set, merged into a global one when the thread exits.
+struct LatencyStats {
+    LatencyHistogram histograms[static_cast<int>(LatencyKind::Count)][2];
+
+    void record(LatencyKind kind, bool emitted, uint64_t ticks) {
+        histograms[static_cast<int>(kind)][emitted].record(ticks);
+    }
+
+    void merge(const LatencyStats &other);
+};
+
+LatencyStats &thread_latency_stats();
+
+class LatencyScope {
+public:
+    LatencyScope(LatencyKind kind, const int &row_index)
+        : kind(kind), row_index(row_index), start_row(row_index), start(latency_now()) {}
+
+    ~LatencyScope() {
+        thread_latency_stats().record(kind, row_index != start_row, latency_now() - start);
+    }
+
+private:
+    LatencyKind kind;
+    const int &row_index;
+    int start_row;
+    uint64_t start;
+};
+
+#define LATENCY_SCOPE(kind, row_index) LatencyScope latency_scope_(kind, row_index)
+
+#else
+
+#define LATENCY_SCOPE(kind, row_index) ((void)0)
+
+#endif
+
+// true when built with LATENCY_STATS
+bool latency_stats_enabled();
+
+// p50/p99/p99.9/max table for everything recorded so far (call once workers
+// have joined); no-op without LATENCY_STATS
+void print_latency_stats(std::ostream &out);
+
+// every non-empty bucket as csv (kind,snapshot,value_ns,count); false on error
+bool dump_latency_stats(const std::string &path);
@@ -1,15 +1,25 @@
 #include <iostream>
-#include <vector>
-#include <fstream>
-#include <sstream>
-#include <unordered_map>
-#include <map>
-#include <list>
-#include <deque>
-#include <iomanip>
+#include <string>
 #include <chrono>
-
-#include "debug_utils.h"
+#include <type_traits>
+
+#include "mbo_parser.h"
+#include "mbo_binary.h"
+#include "mbo_compressed.h"
+#include "book_side.h"
+#include "order_book.h"
+#include "book_manager.h"
+#include "pipeline.h"
+#include "mbo_stream.h"
+#include "streaming.h"
+#include "checkpoint.h"
+#include "latency_stats.h"
+#include "trace.h"
+#include "mbp_writer.h"
+#include "mbp_columnar.h"
+#include "mbp_delta.h"
+#include "mbp_conflate.h"
+#include "parse_number.h"
 
 using namespace std;
 
@@ -47,403 +57,355 @@ using namespace std;
 
  ----------------------------------------------------------------------------------------------------------- */
 
-#ifdef DEBUG
-std::ofstream debug_log_file("logs.txt", std::ios::trunc);
-std::ofstream debug_log_mbp_file("mbp_logs.txt", std::ios::trunc);
-#endif
-
-struct Order {
-    char side; // 'B' for Bid, 'A' for Ask
-    double price;
-    int size;
-};
-
-class OrderBook {
-public:
-    OrderBook() {
-        // Open output CSV file and write header
-        output_file.open("output.csv");
-        write_csv_header();
-    }
-    
-    ~OrderBook() {
-        if (output_file.is_open()) {
-            output_file.close();
+static void print_usage(const char *prog) {
+    std::cerr << "Usage: " << prog << " <mbo.csv|mbo.csv.gz|mbo.csv.zst|mbo.mbob|-|tcp:PORT|udp:PORT> [--book map|ladder] [--depth 1|10|50] [--tick <price>] [--ladder-window <ticks>] [--order-capacity <n>] [--analytics]"
+              << " [--output-format csv|columnar|delta] [--output <path>] [--threads <n>] [--split-instruments]"
+              << " [--pipeline] [--ring-records <n>] [--ring-snapshots <n>] [--pin <parse,book,write cpus>]"
+              << " [--conflate ts|<n>ns|<n>us|<n>ms|<n>s] [--tfc-timeout-ms <ms>] [--latency] [--latency-dump <path>]"
+              << " [--trace <path>] [--trace-records <n>]"
+              << " [--checkpoint <path>] [--checkpoint-every <records>] [--restore <path>]" << std::endl;
+}
+
+// "0,1,2" -> cpus for the parse, book and write stages; "-" leaves one unpinned
+static bool parse_cpu_list(const std::string &list, int cpus[3]) {
+    size_t start = 0;
+    for (int i = 0; i < 3; i++) {
+        size_t end = list.find(',', start);
+        if ((end == std::string::npos) != (i == 2)) return false;
+        std::string item = list.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (item == "-") {
+            cpus[i] = -1;
+        } else if (item.find_first_not_of("0123456789") != std::string::npos ||
+                   !parse_number(item.c_str(), cpus[i])) {
+            return false;
         }
+        start = end + 1;
     }
+    return true;
+}
+
+template<typename Engine>
+static void load_input(const std::string &filename, Engine &engine, std::ostream &log) {
+    Compression compression = detect_compression(filename);
+    if (compression != Compression::None) {
+        MboCompressedReader reader(filename, compression);
+        reader.skip_header(); // skip first row
+        engine.load(reader);
+        reader.print_stats(log);
+    } else if (is_mbo_binary(filename)) {
+        MboBinaryReader reader(filename);
+        engine.load(reader);
+    } else {
+        MboParser parser(filename);
+        parser.skip_header(); // skip first row
+        engine.load(parser);
+    }
+}
+
+// everything main() parsed from the command line
+struct RunOptions {
+    std::string input;
+    std::string output_format = "csv";
+    int depth = MBP_DEPTH;      // levels per side: 1, 10 or 50
+    ManagerConfig manager;      // threads == 0: single book on the calling thread
+    bool pipeline = false;
+    PipelineConfig pipeline_config;
+    bool streaming = false;     // input is "-", "tcp:PORT" or "udp:PORT"
+    StreamEndpoint endpoint;
+    StreamConfig stream_config;
+    CheckpointConfig checkpoint;
+    ConflateConfig conflate;
+
+    bool checkpointing() const { return !checkpoint.save_path.empty() || !checkpoint.restore_path.empty(); }
+
+    // MBP_COLUMNS_* the writer appends
+    uint32_t columns() const {
+        return (conflate.enabled() ? MBP_COLUMNS_CONFLATION : 0) | mbp_columns(manager.book);
+    }
+};
 
-    void load_csv(const std::string &filename) {
-        debug_log_mbp_header();
-
-        std::ifstream file(filename);
-        std::string line;
+// single book with --checkpoint / --restore; the input is checked against
+// the checkpoint before the output is cut back to it
+template<template<bool> class BookSide, typename Writer, int Depth, typename Reader>
+static uint64_t run_with_checkpoints(const RunOptions &options, Reader &reader, CheckpointInput input_format, std::ostream &log) {
+    const ManagerConfig &config = options.manager;
+    CheckpointOutput output_format = std::is_same_v<Writer, MbpColumnarWriter> ? CheckpointOutput::Columnar
+                                     : std::is_same_v<Writer, MbpDeltaWriter>  ? CheckpointOutput::Delta
+                                                                                : CheckpointOutput::Csv;
+    Checkpoint restore;
+    bool restoring = !options.checkpoint.restore_path.empty();
+    if (restoring) {
+        read_checkpoint(options.checkpoint.restore_path, restore);
+        check_restore(restore, input_format, reader.bytes(), output_format, Depth);
+    }
 
-        std::getline(file, line); // skip first row
+    Writer output_file(config.output_path, restoring ? static_cast<int64_t>(restore.output_offset) : -1, Depth,
+                       options.columns());
+    if (!restoring) output_file.write_header();
 
-        while (std::getline(file, line)) {
-            std::stringstream ss(line);
-            std::string cell;
-            std::vector<std::string> row;
+    OrderBook<BookSide, Writer, Depth> book(output_file, config.book);
+    run_checkpointed(book, reader, output_file, options.checkpoint, input_format, output_format,
+                     restoring ? &restore : nullptr, log);
 
-            while (std::getline(ss, cell, ','))
-            {
-                row.push_back(cell);
-            }
+    output_file.flush();
+    return output_file.bytes_written();
+}
 
-            add_to_buffer(row);
-        }
+// one book fed from a file (optionally pipelined) or a stream, rows to output
+template<template<bool> class BookSide, int Depth, typename Output>
+static void run_single(const RunOptions &options, Output &output, std::ostream &log) {
+    const BookConfig &book_config = options.manager.book;
 
-        // cleanup eof buffer
-        while (!buffer_rows.empty()) {
-            debug_log_eof_buffer(buffer_rows);
-            process_row(buffer_rows.front());
-            buffer_rows.pop_front();
-        }
+    if (options.streaming) {
+        MboStreamReader reader(options.endpoint);
+        run_stream<BookSide, Depth>(reader, output, options.stream_config, book_config, log);
+        return;
     }
 
-private:
-    std::ofstream output_file;
-    std::unordered_map<int, Order> orders;
-    std::deque<std::vector<std::string>> buffer_rows;
-    int row_index = 0;
-
-    // maps that hold price level as key, and a list of order_ids as values
-    std::map<double, std::list<int>, std::greater<>> bids;
-    std::map<double, std::list<int>> asks;
-
-    void write_csv_header() {
-        output_file << " ,ts_recv,ts_event,rtype,publisher_id,instrument_id,action,side,depth,price,size,flags,ts_in_delta,sequence";
-        
-        for (int i = 0; i < 10; i++) {
-            output_file << ",bid_px_" << std::setfill('0') << std::setw(2) << i
-                        << ",bid_sz_" << std::setfill('0') << std::setw(2) << i
-                        << ",bid_ct_" << std::setfill('0') << std::setw(2) << i;
-            
-            output_file << ",ask_px_" << std::setfill('0') << std::setw(2) << i
-                        << ",ask_sz_" << std::setfill('0') << std::setw(2) << i
-                        << ",ask_ct_" << std::setfill('0') << std::setw(2) << i;
-        }
-
-        output_file << ",symbol,order_id";
-        output_file << "\n";
+    if (options.pipeline) {
+        Pipeline<BookSide, Output, Depth> stages(output, options.pipeline_config, book_config);
+        load_input(options.input, stages, log);
+        stages.print_stats(log);
+        return;
     }
 
-    void add_to_buffer(std::vector<std::string>& row) {
-        char action = row[5][0];
-        char side = row[6][0];
+    OrderBook<BookSide, Output, Depth> myOrderBook(output, book_config);
+    load_input(options.input, myOrderBook, log);
 
-        if (action == 'T' && side == 'N') {
-            double price = std::stod(row[7]);
-            int size = std::stoi(row[8]);
-
-            get_snapshot(row, 'T', 'N', 0, price, size, 0); // T, N combo
-            
-            return;
-        }
+    output.flush();
+}
 
-        // buffer empty
-        if (buffer_rows.empty() && action != 'T') {
-            process_row(row);
-            return;
-        }
+template<template<bool> class BookSide, typename Writer, int Depth>
+static uint64_t run(const RunOptions &options, std::ostream &log) {
+    const ManagerConfig &config = options.manager;
 
-        // row action is T or buffer not empty
-        buffer_rows.push_back(row);
-        
-        // Process the T-F-C sequence
-        if (buffer_rows.size() == 3) {
-            process_buffer_rows();
-        }
+    if (config.threads > 0) {
+        BookManager<BookSide, Writer, Depth> manager(config);
+        load_input(options.input, manager, log);
+        return manager.output_bytes();
     }
 
-    void process_buffer_rows() {
-        if (buffer_rows.size() != 3) return;
-        
-        const auto &row1 = buffer_rows[0];
-        const auto &row2 = buffer_rows[1];
-        const auto &row3 = buffer_rows[2];
-        
-        char action1 = row1[5][0];
-        char action2 = row2[5][0];
-        char action3 = row3[5][0];
-
-        // Check for T-F-C sequence
-        if (action1 == 'T' && action2 == 'F' && action3 == 'C') {
-            handle_trade_sequence(row1, row2, row3);
-            buffer_rows.clear();
-        } else {
-            // Not a T-F-C sequence, process first row normally and shift buffer
-            process_row(buffer_rows.front());
-            buffer_rows.pop_front();
+    if (options.checkpointing()) {
+        if (is_mbo_binary(options.input)) {
+            MboBinaryReader reader(options.input);
+            return run_with_checkpoints<BookSide, Writer, Depth>(options, reader, CheckpointInput::Binary, log);
         }
+        MboParser parser(options.input);
+        parser.skip_header(); // skip first row
+        return run_with_checkpoints<BookSide, Writer, Depth>(options, parser, CheckpointInput::Csv, log);
     }
 
-    void handle_trade_sequence(
-        const std::vector<std::string> &trade_row, 
-        const std::vector<std::string> &fill_row, 
-        const std::vector<std::string> &cancel_row) 
-    {
-        char trade_side = trade_row[6][0];
-        if (trade_side == 'N') {
-            debug_log_tfc_skip();
-            get_snapshot(trade_row, 'T', 'N', 0, 0, 0, 0); // might remove
-            return;
-        }
+    Writer output_file(config.output_path, -1, Depth, options.columns());
+    output_file.write_header();
 
-        debug_log_process_tfc(trade_side, cancel_row);
-        
-        process_row(cancel_row);
+    if (options.conflate.enabled()) {
+        MbpConflator<Writer, Depth> conflator(output_file, options.conflate);
+        run_single<BookSide, Depth>(options, conflator, log);
+        conflator.print_summary(log);
+    } else {
+        run_single<BookSide, Depth>(options, output_file, log);
     }
 
-    void process_row(const std::vector<std::string> &row) {
-        debug_log_top_of_book(asks, bids);
-
-        char action = row[5][0];
+    return output_file.bytes_written();
+}
 
-        if (action == 'R') {
-            get_snapshot(row, action, 'N', 0, 0, 0, 0);
-            return;
+template<template<bool> class BookSide>
+static uint64_t run(const RunOptions &options, std::ostream &log) {
+    return with_mbp_depth(options.depth, [&](auto depth) {
+        if (options.output_format == "columnar") {
+            return run<BookSide, MbpColumnarWriter, depth.value>(options, log);
         }
-
-        char side = row[6][0];
-
-        double price = std::stod(row[7]);
-        int size = std::stoi(row[8]);
-        int order_id = std::stoi(row[10]);
-
-        bool book_changed = false;
-
-        switch(action) {
-            case 'A':
-                debug_log_order_add(order_id, side, size, price);
-                book_changed = add_order(order_id, price, side, size);
-                break;
-            
-            case 'C':
-                debug_log_order_cancel(order_id, side, size);
-                book_changed = cancel_order(order_id);
-                break;
-
-            case 'T':
-            case 'F':
-            default:
-                break;
-        }
-
-        #ifdef DEBUG
-        bool in_top = side == 'A' ? price_in_top_n(asks, price) : price_in_top_n(bids, price);
-        if (!book_changed && in_top) {
-            debug_log_file << "[WARN] Missed book change for top-10 price: " << price << " at row: " << row_index << "\n";
+        if (options.output_format == "delta") {
+            return run<BookSide, MbpDeltaWriter, depth.value>(options, log);
         }
-        #endif
+        return run<BookSide, MbpCsvWriter, depth.value>(options, log);
+    });
+}
 
+int main(int argc, char *argv[]) {
 
-        if (book_changed) {
-            int depth = calculate_depth(side, price);
-            get_snapshot(row, action, side, depth, price, size, order_id);
-        }
-    }
+    auto start = std::chrono::high_resolution_clock::now();
 
-    int calculate_depth(char side, double price) {
-        int depth = 0;
-        
-        if (side == 'B') {
-            // For bids, count levels above this price
-            for (auto it = bids.begin(); it != bids.end() && it->first > price; ++it) {
-                depth++;
+    std::string book_backend = "map";
+    std::string latency_dump;
+    std::string trace_path;
+    uint64_t trace_records = TRACE_DEFAULT_RECORDS;
+    RunOptions options;
+    ManagerConfig &config = options.manager;
+    PipelineConfig &pipeline = options.pipeline_config;
+    config.threads = 0;
+    config.output_path.clear();
+
+    // a numeric flag whose value does not parse falls through to the usage message
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--book" && i + 1 < argc) {
+            book_backend = argv[++i];
+        } else if (arg == "--tick" && i + 1 < argc) {
+            config.book.tick_size = parse_price(argv[++i]);
+        } else if (arg == "--ladder-window" && i + 1 < argc && parse_number(argv[i + 1], config.book.ladder_window)) {
+            i++;
+        } else if (arg == "--order-capacity" && i + 1 < argc && parse_number(argv[i + 1], config.book.order_capacity)) {
+            i++;
+        } else if (arg == "--analytics") {
+            config.book.analytics = true;
+        } else if (arg == "--depth" && i + 1 < argc && parse_number(argv[i + 1], options.depth)) {
+            i++;
+        } else if (arg == "--output-format" && i + 1 < argc) {
+            options.output_format = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            config.output_path = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc && parse_number(argv[i + 1], config.threads)) {
+            i++;
+        } else if (arg == "--split-instruments") {
+            config.output = InstrumentOutput::PerInstrument;
+        } else if (arg == "--pipeline") {
+            options.pipeline = true;
+        } else if (arg == "--ring-records" && i + 1 < argc && parse_number(argv[i + 1], pipeline.record_ring)) {
+            i++;
+        } else if (arg == "--ring-snapshots" && i + 1 < argc && parse_number(argv[i + 1], pipeline.snapshot_ring)) {
+            i++;
+        } else if (arg == "--pin" && i + 1 < argc) {
+            if (!parse_cpu_list(argv[++i], pipeline.cpus)) {
+                print_usage(argv[0]);
+                return 1;
             }
-        } else if (side == 'A') {
-            // For asks, count levels below this price
-            for (auto it = asks.begin(); it != asks.end() && it->first < price; ++it) {
-                depth++;
+        } else if (arg == "--conflate" && i + 1 < argc) {
+            if (!parse_conflate(argv[++i], options.conflate)) {
+                print_usage(argv[0]);
+                return 1;
             }
+        } else if (arg == "--tfc-timeout-ms" && i + 1 < argc && parse_number(argv[i + 1], options.stream_config.tfc_timeout_ms)) {
+            i++;
+        } else if (arg == "--latency") {
+            options.stream_config.measure_latency = true;
+        } else if (arg == "--latency-dump" && i + 1 < argc) {
+            latency_dump = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--trace-records" && i + 1 < argc && parse_number(argv[i + 1], trace_records)) {
+            i++;
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            options.checkpoint.save_path = argv[++i];
+        } else if (arg == "--checkpoint-every" && i + 1 < argc && parse_number(argv[i + 1], options.checkpoint.every)) {
+            i++;
+        } else if (arg == "--restore" && i + 1 < argc) {
+            options.checkpoint.restore_path = argv[++i];
+        } else if (options.input.empty() && (arg[0] != '-' || arg == "-")) {
+            options.input = arg;
+        } else {
+            print_usage(argv[0]);
+            return 1;
         }
-        
-        return depth;
     }
 
-    void get_snapshot(const std::vector<std::string> &row, char action, char side, int depth, double price, int size, int order_id) {
-        auto bid_it = bids.begin();
-        auto ask_it = asks.begin();
-
-        std::string ts_recv = row[0];
-        std::string ts_event = row[1];
-        std::string rtype = row[2];
-        rtype = "10";
-        std::string publisher_id = row[3];
-        std::string instrument_id = row[4];
-        std::string channel_id = row[9];
-        std::string flags = row[11];
-        std::string ts_in_delta = row[12];
-        std::string sequence = row[13];
-        std::string symbol = row[14];
-
-        // debug output
-        debug_log_mbp_oasps(order_id, action, side, depth, price, size);
-
-        // csv output
-        output_file << row_index << "," << ts_event << "," << ts_event << "," << rtype << "," 
-                    << publisher_id << "," << instrument_id << "," << action << "," 
-                    << side << "," << depth << "," << std::fixed << std::setprecision(2) << price 
-                    << "," << size << "," << flags << "," << ts_in_delta << "," << sequence;
-
-        for (int price_level = 0; price_level < 10; price_level++) {
-            std::string bid_px = "", bid_sz = "", bid_ct = "";
-            std::string ask_px = "", ask_sz = "", ask_ct = "";
-            
-            if (bid_it != bids.end()) {
-                double bid_price = bid_it->first;
-                int bid_size = sum_size(bid_it->second);
-                int bid_count = bid_it->second.size();
-
-                output_file << "," << std::fixed << std::setprecision(2) << bid_price
-                        << "," << bid_size << "," << bid_count;
-                
-                #ifdef DEBUG
-                bid_px = std::to_string(bid_price);
-                bid_sz = std::to_string(bid_size);
-                bid_ct = std::to_string(bid_count);
-                #endif
-
-                bid_it++;
-            } else {
-                output_file << ",,0,0";
-            }
-
-            if (ask_it != asks.end()) {
-                double ask_price = ask_it->first;
-                int ask_size = sum_size(ask_it->second);
-                int ask_count = ask_it->second.size();
-            
-                output_file << "," << std::fixed << std::setprecision(2) << ask_price
-                            << "," << ask_size << "," << ask_count;
-
-                ask_px = std::to_string(ask_it->first);
-                ask_sz = std::to_string(sum_size(ask_it->second));
-                ask_ct = std::to_string(ask_it->second.size());
-
-                #ifdef DEBUG
-                std::string ask_px = std::to_string(ask_price);
-                std::string ask_sz = std::to_string(ask_size);
-                std::string ask_ct = std::to_string(ask_count);
-                #endif
-
-                ask_it++;
-            } else {
-                output_file << ",,0,0";
-            }
-
-            debug_log_levels(bid_px, bid_sz, bid_ct, ask_px, ask_sz, ask_ct);
-        }
+    options.streaming = parse_stream_source(options.input, options.endpoint);
 
-        output_file << "," << symbol << "," << order_id << "\n";
-        // output_file.flush();
-
-        row_index++;
-
-        #ifdef DEBUG
-        debug_log_mbp_file << std::endl;
-        #endif
+    if (options.input.empty() || (book_backend != "map" && book_backend != "ladder") ||
+        (options.depth != 1 && options.depth != 10 && options.depth != 50) ||
+        (options.output_format != "csv" && options.output_format != "columnar" && options.output_format != "delta") ||
+        config.book.tick_size <= 0 || config.book.ladder_window <= 0 || config.threads < 0 ||
+        pipeline.record_ring == 0 || pipeline.snapshot_ring == 0 || options.stream_config.tfc_timeout_ms < 0 || trace_records == 0) {
+        print_usage(argv[0]);
+        return 1;
     }
 
-    bool add_order(int order_id, double price, char side, int size) {
-        Order order = { side, price, size};
-        orders[order_id] = order;
-        
-        std::map<double, std::list<int>, std::greater<>> *book = nullptr;
-        if (side == 'A') {
-            asks[price].push_back(order_id);
-            return price_in_top_n(asks, price);
-
-        } else if (side == 'B') {
-            bids[price].push_back(order_id);
-            return price_in_top_n(bids, price);
-        }
-
-        return false;
+    if (!latency_dump.empty() && !latency_stats_enabled()) {
+        std::cerr << "Error: --latency-dump needs a build with LATENCY_STATS (make latency)" << std::endl;
+        return 1;
     }
 
-    bool cancel_order(int order_id) {
-        auto it = orders.find(order_id);
-        if (it == orders.end()) return false;
-
-        Order order_to_cancel = it->second;
-        double price = order_to_cancel.price;
-        char side = order_to_cancel.side;
-
-        bool was_in_top = false;
-        bool is_in_top = false;
-
-        if (side == 'A') {
-            was_in_top = price_in_top_n(asks, price);
-
-            auto price_it = asks.find(price);
-            if (price_it != asks.end()) {
-                price_it->second.remove(order_id);
-                if (price_it->second.empty()) {
-                    asks.erase(price_it);
-                }
-            }
-
-            is_in_top = price_in_top_n(asks, price);
+    #ifdef DEBUG
+    // debug builds always trace, `./mbo_trace trace.bin` renders it
+    if (trace_path.empty()) {
+        trace_path = "trace.bin";
+    }
+    #endif
 
-        } else if (side == 'B') {
-            was_in_top = price_in_top_n(bids, price);
+    if (options.pipeline && (config.threads > 0 || config.output == InstrumentOutput::PerInstrument)) {
+        std::cerr << "Error: --pipeline runs a single book, it cannot be combined with --threads" << std::endl;
+        return 1;
+    }
 
-            auto price_it = bids.find(price);
-            if (price_it != bids.end()) {
-                price_it->second.remove(order_id);
-                if (price_it->second.empty()) {
-                    bids.erase(price_it);
-                }
-            }
+    if (options.streaming && (options.pipeline || config.threads > 0 || config.output == InstrumentOutput::PerInstrument)) {
+        std::cerr << "Error: stream input runs a single book, it cannot be combined with --pipeline or --threads" << std::endl;
+        return 1;
+    }
 
-            is_in_top = price_in_top_n(bids, price);
-        }
+    if (options.checkpointing() && (options.streaming || options.pipeline || config.threads > 0 ||
+                                    config.output == InstrumentOutput::PerInstrument)) {
+        std::cerr << "Error: --checkpoint / --restore run a single book on a file input, they cannot be combined"
+                  << " with stream input, --pipeline or --threads" << std::endl;
+        return 1;
+    }
 
-        orders.erase(order_id);
+    if (options.conflate.enabled() && (options.checkpointing() || config.threads > 0 ||
+                                       config.output == InstrumentOutput::PerInstrument)) {
+        std::cerr << "Error: --conflate runs a single book, it cannot be combined with --threads or"
+                  << " --checkpoint / --restore" << std::endl;
+        return 1;
+    }
 
-        return was_in_top || is_in_top;
+    if (options.checkpointing() && !options.streaming && detect_compression(options.input) != Compression::None) {
+        std::cerr << "Error: --checkpoint / --restore need a seekable input, decompress the file first" << std::endl;
+        return 1;
     }
 
-    // CLASS HELP FUNCTIONS
-    int sum_size(std::list<int>& order_ids) {
-        int total = 0;
-        for (int id : order_ids) {
-            total += orders.at(id).size;
-        }
-        return total;
+    if (options.checkpoint.every > 0 && options.checkpoint.save_path.empty()) {
+        std::cerr << "Error: --checkpoint-every needs --checkpoint <path>" << std::endl;
+        return 1;
     }
 
-    template<typename BookType>
-    bool price_in_top_n(const BookType& book, double price, int N = 10) {
-        int count = 0;
-        for (const auto& [p, _] : book) {
-            if (count++ > N) break;
-            if (p == price) return true;
-        }
-        return false;
+    if (!options.checkpoint.save_path.empty()) {
+        install_checkpoint_signal(); // kill -USR1 <pid> writes a checkpoint on demand
     }
-};
 
-int main(int argc, char *argv[]) {
+    if (config.output == InstrumentOutput::PerInstrument && config.threads == 0) {
+        config.threads = 1;
+    }
 
-    auto start = std::chrono::high_resolution_clock::now();
+    if (config.output_path.empty()) {
+        config.output_path = options.output_format == "columnar" ? "output.mbpc"
+                             : options.output_format == "delta"  ? "output.mbpd"
+                                                                 : "output.csv";
+    }
 
-    std::string filename = argv[1];
+    // "--output -" streams rows to stdout, status lines move to stderr
+    bool to_stdout = config.output_path == "-";
+    if (to_stdout) {
+        config.output_path = "/dev/stdout";
+    }
+    std::ostream &log = to_stdout ? std::cerr : std::cout;
 
-    OrderBook myOrderBook;
+    uint64_t output_bytes = 0;
 
-    myOrderBook.load_csv(filename);
+    try {
+        if (!trace_path.empty()) {
+            trace_open(trace_path, trace_records);
+        }
+        if (book_backend == "ladder") {
+            output_bytes = run<LadderBookSide>(options, log);
+        } else {
+            output_bytes = run<MapBookSide>(options, log);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    trace_close();
 
     auto end = std::chrono::high_resolution_clock::now();
 
-    #ifdef DEBUG
-    debug_log_file.close();
-    #endif
 
     std::chrono::duration<double> duration = end - start;
-    std::cout << "Execution time: " << duration.count() << " seconds" << std::endl;
+    log << "Execution time: " << duration.count() << " seconds" << std::endl;
+    log << "Output: " << output_bytes << " bytes (" << config.output_path << ")" << std::endl;
+
+    print_latency_stats(log);
+    if (!latency_dump.empty() && !dump_latency_stats(latency_dump)) {
+        std::cerr << "Error: cannot write " << latency_dump << std::endl;
+        return 1;
+    }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,39 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string &filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + filename);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot stat " + filename);
+    }
+    length = static_cast<size_t>(st.st_size);
+
+    if (length > 0) {
+        void *mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("cannot mmap " + filename);
+        }
+        ::madvise(mapped, length, MADV_SEQUENTIAL);
+        base = static_cast<const char *>(mapped);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (base) {
+        ::munmap(const_cast<char *>(base), length);
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only mmap of a whole file, unmapped on destruction. Throws
+// std::runtime_error if the file cannot be opened or mapped.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return base; }
+    size_t size() const { return length; }
+
+private:
+    const char *base = nullptr;
+    size_t length = 0;
+};
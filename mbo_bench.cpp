@@ -0,0 +1,308 @@
+// Benchmark suite. Microbenchmarks for add, cancel, snapshot encoding and
+// parsing, the timestamp codec (generic vs simd parse, plain vs cached
+// format) plus end-to-end runs, one JSON object per line on stdout:
+//
+//   {"bench":"add","backend":"map","depth":10,"events":...,"events_per_sec":...,
+//    "p50_ns":...,"p99_ns":...,"p999_ns":...,"max_ns":...,"peak_rss_kb":...}
+//
+//   ./mbo_bench data.csv [--orders N] [--max-events N]
+//
+// Every benchmark runs twice: an untimed pass for events/s and a pass that
+// reads the clock around each event for the ns/event percentiles (those
+// include the clock overhead, ~20 ns). peak_rss_kb is the process high-water
+// mark when the benchmark finished. end_to_end also runs at MBP-1 (BBO) and
+// MBP-50, and with book analytics (book vs book_analytics isolates their
+// upkeep). data.csv comes from mbo_gen.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "book_side.h"
+#include "mbo_generator.h"
+#include "mbo_parser.h"
+#include "mbp_snapshot.h"
+#include "mbp_writer.h"
+#include "order_book.h"
+#include "parse_number.h"
+#include "timestamp.h"
+
+using Clock = std::chrono::steady_clock;
+
+// snapshots kept for the encoding benchmark, cycled over
+static constexpr size_t SNAPSHOT_SAMPLE = 100000;
+
+// records held in memory for the book-only benchmarks
+static constexpr size_t BOOK_SAMPLE = 2000000;
+
+// keeps the optimizer from dropping the work
+static volatile uint64_t sink;
+
+struct NullWriter {
+    uint64_t rows = 0;
+    template<int Depth>
+    void write_row(const MbpSnapshot<Depth> &snap) { rows += snap.bid_count + snap.ask_count; }
+};
+
+struct CapturedRow {
+    MboRecord rec;
+    MbpSnapshot<> snap;
+};
+
+struct CaptureWriter {
+    std::vector<CapturedRow> rows;
+    void write_row(const MbpSnapshot<> &snap) {
+        if (rows.size() < SNAPSHOT_SAMPLE) rows.push_back({ *snap.rec, snap });
+    }
+};
+
+static long peak_rss_kb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Runs fn(i) for i in [0, n) once untimed and once with per-event samples;
+// setup() runs before each pass and resets any state.
+// depth is the MBP depth of the books involved, printed as is.
+template<typename Setup, typename Fn>
+static void run_bench(const char *bench, const char *backend, size_t n, Setup setup, Fn fn, int depth = MBP_DEPTH) {
+    setup();
+    auto start = Clock::now();
+    for (size_t i = 0; i < n; i++) fn(i);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<uint32_t> ns(n);
+    setup();
+    for (size_t i = 0; i < n; i++) {
+        auto t0 = Clock::now();
+        fn(i);
+        ns[i] = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+    }
+
+    auto pct = [&](double q) {
+        if (ns.empty()) return uint32_t(0);
+        size_t k = static_cast<size_t>(q * (ns.size() - 1));
+        std::nth_element(ns.begin(), ns.begin() + k, ns.end());
+        return ns[k];
+    };
+    uint32_t p50 = pct(0.5), p99 = pct(0.99), p999 = pct(0.999);
+    uint32_t max = ns.empty() ? 0 : *std::max_element(ns.begin(), ns.end());
+
+    std::cout << "{\"bench\":\"" << bench << "\",\"backend\":\"" << backend << "\",\"depth\":" << depth
+              << ",\"events\":" << n
+              << ",\"events_per_sec\":" << static_cast<uint64_t>(seconds > 0 ? n / seconds : 0)
+              << ",\"p50_ns\":" << p50 << ",\"p99_ns\":" << p99 << ",\"p999_ns\":" << p999
+              << ",\"max_ns\":" << max << ",\"peak_rss_kb\":" << peak_rss_kb() << "}" << std::endl;
+}
+
+// add N orders into an empty book, then cancel them in random order
+template<template<bool> class BookSide>
+static void bench_add_cancel(const char *backend, int orders) {
+    GeneratorConfig config;
+    config.rows = static_cast<uint64_t>(orders) + 1; // R row + adds
+    config.orders = orders;
+    config.cancel_ratio = 0;
+    config.tfc_rate = 0;
+    config.trade_n_rate = 0;
+
+    std::vector<MboRecord> adds;
+    MboGenerator generator(config);
+    MboRecord rec;
+    generator.next(rec); // R
+    while (generator.next(rec)) adds.push_back(rec);
+
+    std::vector<MboRecord> cancels = adds;
+    std::shuffle(cancels.begin(), cancels.end(), std::mt19937_64(7));
+    for (MboRecord &c : cancels) c.action = 'C';
+
+    NullWriter out;
+    std::unique_ptr<OrderBook<BookSide, NullWriter>> book;
+    auto fresh = [&] { book = std::make_unique<OrderBook<BookSide, NullWriter>>(out); };
+
+    run_bench("add", backend, adds.size(), fresh, [&](size_t i) { book->on_mbo(adds[i]); });
+
+    auto filled = [&] {
+        fresh();
+        for (const MboRecord &a : adds) book->on_mbo(a);
+    };
+    run_bench("cancel", backend, cancels.size(), filled, [&](size_t i) { book->on_mbo(cancels[i]); });
+
+    sink = out.rows;
+}
+
+// book only, records parsed up front: the book_analytics run keeps the
+// incremental BookFeatures (book_analytics.h), the difference is their cost
+template<template<bool> class BookSide>
+static void bench_analytics(const char *backend, const std::vector<MboRecord> &records) {
+    NullWriter out;
+    std::unique_ptr<OrderBook<BookSide, NullWriter>> book;
+
+    for (bool analytics : { false, true }) {
+        BookConfig config;
+        config.analytics = analytics;
+        run_bench(analytics ? "book_analytics" : "book", backend, records.size(), [&] {
+            book.reset();
+            book = std::make_unique<OrderBook<BookSide, NullWriter>>(out, config);
+        }, [&](size_t i) { book->on_mbo(records[i]); });
+    }
+
+    sink = out.rows;
+}
+
+// parse + book + csv encode at MBP-Depth, output to /dev/null; with analytics
+// the features are kept and written as extra columns
+template<template<bool> class BookSide, int Depth = MBP_DEPTH>
+static void bench_end_to_end(const char *backend, const std::string &filename, size_t rows, bool analytics = false) {
+    std::unique_ptr<MboParser> parser;
+    std::unique_ptr<MbpCsvWriter> writer;
+    std::unique_ptr<OrderBook<BookSide, MbpCsvWriter, Depth>> book;
+    MboRecord rec;
+    BookConfig config;
+    config.analytics = analytics;
+
+    auto fresh = [&] {
+        book.reset();
+        writer = std::make_unique<MbpCsvWriter>("/dev/null", -1, Depth, analytics ? MBP_COLUMNS_ANALYTICS : 0);
+        book = std::make_unique<OrderBook<BookSide, MbpCsvWriter, Depth>>(*writer, config);
+        parser = std::make_unique<MboParser>(filename);
+        parser->skip_header();
+    };
+
+    run_bench(analytics ? "end_to_end_analytics" : "end_to_end", backend, rows, fresh, [&](size_t) {
+        parser->next(rec);
+        book->on_mbo(rec);
+    }, Depth);
+
+    sink = writer->bytes_written();
+}
+
+int main(int argc, char *argv[]) {
+    std::string filename;
+    int orders = 1000000;
+    size_t max_events = SIZE_MAX;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--orders" && i + 1 < argc && parse_number(argv[i + 1], orders)) {
+            i++;
+        } else if (arg == "--max-events" && i + 1 < argc && parse_number(argv[i + 1], max_events)) {
+            i++;
+        } else if (filename.empty() && arg[0] != '-') {
+            filename = arg;
+        } else {
+            filename.clear();
+            break;
+        }
+    }
+
+    if (filename.empty() || orders <= 0) {
+        std::cerr << "Usage: " << argv[0] << " <data.csv> [--orders N] [--max-events N]" << std::endl;
+        return 1;
+    }
+
+    try {
+        // rows in the file, capped
+        size_t rows = 0;
+        {
+            MboParser counter(filename);
+            MboRecord rec;
+            counter.skip_header();
+            while (rows < max_events && counter.next(rec)) rows++;
+        }
+
+        std::unique_ptr<MboParser> parser;
+        MboRecord rec;
+        run_bench("parse", "mmap", rows, [&] {
+            parser = std::make_unique<MboParser>(filename);
+            parser->skip_header();
+        }, [&](size_t) { parser->next(rec); });
+
+        // snapshot encoding over rows captured from the data; the parser stays
+        // alive for the symbols the captured records point at
+        CaptureWriter captured;
+        MboParser capture_parser(filename);
+        {
+            OrderBook<MapBookSide, CaptureWriter> book(captured);
+            capture_parser.skip_header();
+            while (captured.rows.size() < SNAPSHOT_SAMPLE && capture_parser.next(rec)) book.on_mbo(rec);
+        }
+        if (!captured.rows.empty()) {
+            std::unique_ptr<MbpCsvWriter> writer;
+            size_t n = std::min(rows, static_cast<size_t>(SNAPSHOT_SAMPLE) * 10);
+            run_bench("snapshot", "csv", n, [&] {
+                writer = std::make_unique<MbpCsvWriter>("/dev/null");
+            }, [&](size_t i) {
+                CapturedRow &row = captured.rows[i % captured.rows.size()];
+                row.snap.rec = &row.rec;
+                writer->write_row(row.snap);
+            });
+        }
+
+        // timestamp codec over the ts_event column of the data
+        std::vector<int64_t> stamps;
+        {
+            MboParser stamp_parser(filename);
+            stamp_parser.skip_header();
+            while (stamps.size() < SNAPSHOT_SAMPLE && stamp_parser.next(rec)) stamps.push_back(rec.ts_event);
+        }
+        if (!stamps.empty()) {
+            std::vector<char> text(stamps.size() * TIMESTAMP_TEXT_SIZE);
+            for (size_t i = 0; i < stamps.size(); i++) format_timestamp(&text[i * TIMESTAMP_TEXT_SIZE], stamps[i]);
+            auto text_at = [&](size_t i) {
+                return std::string_view(&text[(i % stamps.size()) * TIMESTAMP_TEXT_SIZE], TIMESTAMP_TEXT_SIZE);
+            };
+            size_t n = std::min(rows, static_cast<size_t>(SNAPSHOT_SAMPLE) * 10);
+
+            run_bench("ts_parse", "generic", n, [] {}, [&](size_t i) { sink = parse_timestamp_generic(text_at(i)); });
+            run_bench("ts_parse", "simd", n, [] {}, [&](size_t i) { sink = parse_timestamp(text_at(i)); });
+
+            char out[TIMESTAMP_TEXT_SIZE];
+            TimestampFormatter formatter;
+            run_bench("ts_format", "plain", n, [] {}, [&](size_t i) {
+                format_timestamp(out, stamps[i % stamps.size()]);
+                sink = out[28];
+            });
+            run_bench("ts_format", "cached", n, [&] { formatter = TimestampFormatter(); }, [&](size_t i) {
+                formatter.format(out, stamps[i % stamps.size()]);
+                sink = out[28];
+            });
+        }
+
+        bench_add_cancel<MapBookSide>("map", orders);
+        bench_add_cancel<LadderBookSide>("ladder", orders);
+
+        // analytics off / on, book only and end to end
+        {
+            std::vector<MboRecord> records;
+            MboParser record_parser(filename);
+            record_parser.skip_header();
+            while (records.size() < std::min(rows, BOOK_SAMPLE) && record_parser.next(rec)) records.push_back(rec);
+            bench_analytics<MapBookSide>("map", records);
+            bench_analytics<LadderBookSide>("ladder", records);
+        }
+        bench_end_to_end<MapBookSide>("map", filename, rows, true);
+        bench_end_to_end<LadderBookSide>("ladder", filename, rows, true);
+
+        bench_end_to_end<MapBookSide>("map", filename, rows);
+        bench_end_to_end<LadderBookSide>("ladder", filename, rows);
+
+        // BBO and deep book, same input
+        bench_end_to_end<MapBookSide, 1>("map", filename, rows);
+        bench_end_to_end<LadderBookSide, 1>("ladder", filename, rows);
+        bench_end_to_end<MapBookSide, 50>("map", filename, rows);
+        bench_end_to_end<LadderBookSide, 50>("ladder", filename, rows);
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
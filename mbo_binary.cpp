@@ -0,0 +1,103 @@
+#include "mbo_binary.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+
+bool is_mbo_binary(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(MBO_BINARY_MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+    return file && std::memcmp(magic, MBO_BINARY_MAGIC, sizeof(magic)) == 0;
+}
+
+MboBinaryReader::MboBinaryReader(const std::string &filename) : file(filename) {
+    const char *data = file.data();
+    size_t size = file.size();
+
+    if (size < sizeof(MboBinaryHeader)) {
+        throw std::runtime_error(filename + ": truncated binary MBO header");
+    }
+
+    MboBinaryHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, MBO_BINARY_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != MBO_BINARY_VERSION || header.record_size != sizeof(MboBinaryRecord)) {
+        throw std::runtime_error(filename + ": not a binary MBO file (version " + std::to_string(MBO_BINARY_VERSION) + ")");
+    }
+    if (header.price_scale_digits != PRICE_SCALE_DIGITS) {
+        throw std::runtime_error(filename + ": price scale mismatch, file uses " +
+                                 std::to_string(header.price_scale_digits) + " digits");
+    }
+    if (header.records_offset + header.record_count * sizeof(MboBinaryRecord) > size ||
+        header.symbols_offset + header.symbol_count * sizeof(MboBinarySymbol) > size) {
+        throw std::runtime_error(filename + ": truncated binary MBO file");
+    }
+
+    records = reinterpret_cast<const MboBinaryRecord *>(data + header.records_offset);
+    symbols = reinterpret_cast<const MboBinarySymbol *>(data + header.symbols_offset);
+    record_count = header.record_count;
+    symbol_count = header.symbol_count;
+    records_offset = header.records_offset;
+}
+
+void MboBinaryReader::seek(size_t offset) {
+    if (offset < records_offset || (offset - records_offset) % sizeof(MboBinaryRecord) != 0 ||
+        (offset - records_offset) / sizeof(MboBinaryRecord) > record_count) {
+        throw std::runtime_error("seek to " + std::to_string(offset) + " is not a record boundary");
+    }
+    index = (offset - records_offset) / sizeof(MboBinaryRecord);
+}
+
+MboBinaryRecord encode_binary_record(const MboRecord &rec, uint16_t symbol_index) {
+    MboBinaryRecord r = {};
+    r.ts_recv = rec.ts_recv;
+    r.ts_event = rec.ts_event;
+    r.price = rec.price;
+    r.order_id = rec.order_id;
+    r.size = static_cast<uint32_t>(rec.size);
+    r.sequence = rec.sequence;
+    r.ts_in_delta = rec.ts_in_delta;
+    r.instrument_id = rec.instrument_id;
+    r.publisher_id = rec.publisher_id;
+    r.symbol_index = symbol_index;
+    r.action = static_cast<uint8_t>(rec.action);
+    r.side = static_cast<uint8_t>(rec.side);
+    r.flags = rec.flags;
+    r.channel_id = rec.channel_id;
+    r.rtype = rec.rtype;
+    return r;
+}
+
+void decode_binary_record(const MboBinaryRecord &r, std::string_view symbol, MboRecord &rec) {
+    rec.ts_recv = r.ts_recv;
+    rec.ts_event = r.ts_event;
+    rec.rtype = r.rtype;
+    rec.publisher_id = r.publisher_id;
+    rec.instrument_id = r.instrument_id;
+    rec.action = static_cast<char>(r.action);
+    rec.side = static_cast<char>(r.side);
+    rec.price = r.price;
+    rec.size = static_cast<int>(r.size);
+    rec.channel_id = r.channel_id;
+    rec.order_id = r.order_id;
+    rec.flags = r.flags;
+    rec.ts_in_delta = r.ts_in_delta;
+    rec.sequence = r.sequence;
+    rec.symbol = symbol;
+}
+
+bool MboBinaryReader::next(MboRecord &rec) {
+    if (index >= record_count) return false;
+    const MboBinaryRecord &r = records[index++];
+
+    std::string_view symbol;
+    if (r.symbol_index < symbol_count) {
+        const char *name = symbols[r.symbol_index].name;
+        symbol = std::string_view(name, strnlen(name, sizeof(MboBinarySymbol::name)));
+    }
+    decode_binary_record(r, symbol, rec);
+    return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "mapped_file.h"
+#include "mbo_parser.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "the binary MBO format is little-endian, records are read in place"
+#endif
+
+// Binary MBO file layout (little-endian, written by mbo_convert):
+//
+//   MboBinaryHeader
+//   MboBinaryRecord x record_count      at records_offset
+//   MboBinarySymbol x symbol_count      at symbols_offset
+//
+// Records are fixed width, so a mapped file is iterated with no parsing.
+
+constexpr char MBO_BINARY_MAGIC[8] = { 'M', 'B', 'O', 'B', 'I', 'N', '0', '1' };
+constexpr uint32_t MBO_BINARY_VERSION = 1;
+
+struct MboBinaryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t record_count;
+    uint64_t records_offset;
+    uint64_t symbols_offset;
+    uint32_t symbol_count;
+    int32_t price_scale_digits;
+};
+static_assert(sizeof(MboBinaryHeader) == 48, "MboBinaryHeader layout");
+
+struct MboBinaryRecord {
+    int64_t ts_recv;   // epoch ns
+    int64_t ts_event;  // epoch ns
+    int64_t price;     // fixed-point ticks, see price_scale_digits
+    uint64_t order_id;
+    uint32_t size;
+    uint32_t sequence;
+    int32_t ts_in_delta;
+    uint32_t instrument_id;
+    uint16_t publisher_id;
+    uint16_t symbol_index; // into the symbol table
+    uint8_t action;
+    uint8_t side;
+    uint8_t flags;
+    uint8_t channel_id;
+    uint8_t rtype;
+    uint8_t reserved[7];
+};
+static_assert(sizeof(MboBinaryRecord) == 64, "MboBinaryRecord layout");
+
+struct MboBinarySymbol {
+    char name[32]; // NUL padded
+};
+
+// true if the file starts with MBO_BINARY_MAGIC
+bool is_mbo_binary(const std::string &filename);
+
+// MboRecord <-> fixed-width record; the symbol is stored by index
+MboBinaryRecord encode_binary_record(const MboRecord &rec, uint16_t symbol_index);
+void decode_binary_record(const MboBinaryRecord &r, std::string_view symbol, MboRecord &rec);
+
+// Memory-mapped reader for the binary format, same next() contract as MboParser.
+class MboBinaryReader {
+public:
+    explicit MboBinaryReader(const std::string &filename);
+
+    bool next(MboRecord &rec);
+
+    size_t bytes() const { return file.size(); }
+    size_t rows() const { return index; }
+
+    // byte position of the next record, and back (for checkpoint resume)
+    size_t offset() const { return records_offset + index * sizeof(MboBinaryRecord); }
+    void seek(size_t offset);
+
+private:
+    MappedFile file;
+    const MboBinaryRecord *records = nullptr;
+    const MboBinarySymbol *symbols = nullptr;
+    uint64_t record_count = 0;
+    uint32_t symbol_count = 0;
+    size_t records_offset = 0;
+    size_t index = 0;
+};
@@ -0,0 +1,293 @@
+#include "mbo_compressed.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <zlib.h>
+#ifdef MBO_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+static double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+Compression detect_compression(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    unsigned char magic[4] = {};
+    file.read(reinterpret_cast<char *>(magic), sizeof(magic));
+    if (!file) return Compression::None;
+
+    if (magic[0] == 0x1f && magic[1] == 0x8b) return Compression::Gzip;
+    if (magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) return Compression::Zstd;
+    return Compression::None;
+}
+
+const char *compression_name(Compression compression) {
+    switch (compression) {
+        case Compression::Gzip: return "gzip";
+        case Compression::Zstd: return "zstd";
+        default: return "none";
+    }
+}
+
+// DECODERS
+// read(out, n) fills out completely unless the input ends, returns the bytes
+// written (0 once everything is out). Throws on corrupt or truncated input.
+
+class GzipDecoder {
+public:
+    GzipDecoder(const char *data, size_t size) : in(data), in_left(size) {
+        std::memset(&zs, 0, sizeof(zs));
+        if (inflateInit2(&zs, 15 + 32) != Z_OK) { // 15 + 32: zlib or gzip header
+            throw std::runtime_error("inflateInit2 failed");
+        }
+    }
+
+    ~GzipDecoder() { inflateEnd(&zs); }
+
+    size_t read(char *out, size_t n) {
+        zs.next_out = reinterpret_cast<Bytef *>(out);
+        zs.avail_out = static_cast<uInt>(n);
+
+        while (zs.avail_out > 0 && !finished) {
+            if (zs.avail_in == 0 && in_left > 0) {
+                // avail_in is 32-bit, feed big files in slices
+                size_t slice = in_left < (1u << 30) ? in_left : (1u << 30);
+                zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in));
+                zs.avail_in = static_cast<uInt>(slice);
+                in += slice;
+                in_left -= slice;
+            }
+
+            int rc = inflate(&zs, Z_NO_FLUSH);
+            if (rc == Z_STREAM_END) {
+                // concatenated members (cat a.gz b.gz) continue the stream
+                if (zs.avail_in > 0 || in_left > 0) {
+                    inflateReset(&zs);
+                } else {
+                    finished = true;
+                }
+            } else if (rc == Z_BUF_ERROR && zs.avail_in == 0 && in_left == 0) {
+                throw std::runtime_error("truncated gzip input");
+            } else if (rc != Z_OK) {
+                throw std::runtime_error(std::string("gzip: ") + (zs.msg ? zs.msg : "corrupt input"));
+            }
+        }
+        return n - zs.avail_out;
+    }
+
+private:
+    z_stream zs;
+    const char *in;
+    size_t in_left;
+    bool finished = false;
+};
+
+#ifdef MBO_HAVE_ZSTD
+class ZstdDecoder {
+public:
+    ZstdDecoder(const char *data, size_t size) : ctx(ZSTD_createDCtx()) {
+        if (!ctx) throw std::runtime_error("ZSTD_createDCtx failed");
+        in = { data, size, 0 };
+    }
+
+    ~ZstdDecoder() { ZSTD_freeDCtx(ctx); }
+
+    size_t read(char *out, size_t n) {
+        ZSTD_outBuffer buffer = { out, n, 0 };
+        while (buffer.pos < buffer.size) {
+            // the last call that made progress ended a frame: done, or the
+            // next concatenated frame (zstd a b) follows
+            if (in.pos == in.size && !frame_open) break;
+
+            size_t in_before = in.pos, out_before = buffer.pos;
+            size_t rc = ZSTD_decompressStream(ctx, &buffer, &in);
+            if (ZSTD_isError(rc)) {
+                throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(rc));
+            }
+            // a call without progress returns a size hint for the next
+            // frame, not the state of the one just read
+            if (in.pos == in_before && buffer.pos == out_before) {
+                if (frame_open) throw std::runtime_error("truncated zstd input");
+                break;
+            }
+            frame_open = rc != 0;
+        }
+        return buffer.pos;
+    }
+
+private:
+    ZSTD_DCtx *ctx;
+    ZSTD_inBuffer in;
+    bool frame_open = false;
+};
+#endif
+
+// READER
+MboCompressedReader::MboCompressedReader(const std::string &filename, Compression compression)
+    : file(filename), filename(filename), compression(compression),
+      chunks(CHUNK_COUNT, std::vector<char>(CHUNK_SIZE)), chunk_used(CHUNK_COUNT, 0),
+      filled(CHUNK_COUNT + 1), free_chunks(CHUNK_COUNT) {
+#ifndef MBO_HAVE_ZSTD
+    if (compression == Compression::Zstd) {
+        throw std::runtime_error(filename + ": zstd input needs a build with zstd support (make ZSTD=1)");
+    }
+#endif
+    if (compression == Compression::None) {
+        throw std::runtime_error(filename + ": not a gzip or zstd file");
+    }
+
+    for (int i = 0; i < CHUNK_COUNT; i++) {
+        free_chunks.push(i);
+    }
+    decoder = std::thread([this] { run_decoder(); });
+}
+
+MboCompressedReader::~MboCompressedReader() {
+    stop.store(true, std::memory_order_relaxed);
+    decoder.join();
+}
+
+void MboCompressedReader::run_decoder() {
+    try {
+        if (compression == Compression::Gzip) {
+            GzipDecoder gzip(file.data(), file.size());
+            decode(gzip);
+        }
+#ifdef MBO_HAVE_ZSTD
+        if (compression == Compression::Zstd) {
+            ZstdDecoder zstd(file.data(), file.size());
+            decode(zstd);
+        }
+#endif
+    } catch (const std::exception &e) {
+        error = e.what();
+        filled.push(DECODE_ERROR);
+    }
+}
+
+bool MboCompressedReader::take_free(int &index) {
+    if (free_chunks.try_pop(index)) return true;
+
+    auto start = Clock::now();
+    for (int spins = 0; !free_chunks.try_pop(index); spins++) {
+        if (stop.load(std::memory_order_relaxed)) return false; // reader went away mid-input
+        if (spins > 64) std::this_thread::yield();
+    }
+    decoder_blocked += seconds_since(start);
+    return true;
+}
+
+// Inflates into one free chunk at a time. A full chunk is cut after its last
+// newline and the partial line moves to the front of the next chunk.
+template<typename Decoder>
+void MboCompressedReader::decode(Decoder &source) {
+    auto start = Clock::now();
+    int index;
+    if (!take_free(index)) return;
+    size_t used = 0;
+
+    while (true) {
+        char *buf = chunks[index].data();
+        size_t n = source.read(buf + used, CHUNK_SIZE - used);
+        used += n;
+        out_bytes += n;
+
+        if (used < CHUNK_SIZE) {
+            // end of input; the last line may lack its newline
+            if (used > 0) {
+                chunk_used[index] = used;
+                filled.push(index);
+            }
+            break;
+        }
+
+        const char *newline = static_cast<const char *>(memrchr(buf, '\n', used));
+        if (!newline) {
+            throw std::runtime_error("line longer than " + std::to_string(CHUNK_SIZE) + " bytes");
+        }
+        size_t keep = static_cast<size_t>(newline - buf) + 1;
+
+        int next_index;
+        if (!take_free(next_index)) return;
+        std::memcpy(chunks[next_index].data(), buf + keep, used - keep);
+
+        chunk_used[index] = keep;
+        filled.push(index);
+
+        used -= keep;
+        index = next_index;
+    }
+
+    decode_wall = seconds_since(start);
+    filled.push(END_OF_INPUT);
+}
+
+bool MboCompressedReader::next_chunk() {
+    if (current >= 0) {
+        free_chunks.push(current);
+        current = -1;
+    }
+    if (done) return false;
+
+    int index;
+    if (!filled.try_pop(index)) {
+        auto start = Clock::now();
+        filled.pop(index);
+        parser_starved += seconds_since(start);
+    }
+
+    if (index == END_OF_INPUT || index == DECODE_ERROR) {
+        done = true;
+        if (index == DECODE_ERROR) throw std::runtime_error(filename + ": " + error);
+        return false;
+    }
+
+    current = index;
+    cur = chunks[index].data();
+    end = cur + chunk_used[index];
+    return true;
+}
+
+void MboCompressedReader::skip_header() {
+    std::string_view fields[MBO_FIELD_COUNT];
+    int field_count = 0;
+    if (cur < end || next_chunk()) {
+        cur = split_mbo_line(cur, end, fields, field_count);
+    }
+}
+
+bool MboCompressedReader::next(MboRecord &rec) {
+    std::string_view fields[MBO_FIELD_COUNT];
+    int field_count = 0;
+
+    // skip blank lines, stop on a complete row
+    do {
+        if (cur >= end && !next_chunk()) return false;
+        cur = split_mbo_line(cur, end, fields, field_count);
+    } while (field_count < MBO_FIELD_COUNT - 1);
+
+    decode_mbo_fields(fields, field_count, rec);
+
+    // the chunk is reused, the symbol must not point into it
+    if (rec.symbol != last_symbol) {
+        last_symbol = *symbols.emplace(rec.symbol).first;
+    }
+    rec.symbol = last_symbol;
+
+    row_count++;
+    return true;
+}
+
+void MboCompressedReader::print_stats(std::ostream &out) const {
+    double mb_in = file.size() / 1e6;
+    double mb_out = out_bytes / 1e6;
+    out << "Decompressed (" << compression_name(compression) << "): " << mb_in << " MB -> " << mb_out
+        << " MB in " << decode_wall << " s (" << (decode_wall > 0 ? mb_out / decode_wall : 0) << " MB/s out), "
+        << "decoder blocked " << decoder_blocked << " s, parser starved " << parser_starved << " s" << std::endl;
+}
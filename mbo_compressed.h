@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "mapped_file.h"
+#include "mbo_parser.h"
+#include "spsc_ring.h"
+
+// Compressed MBO csv input (archived days), read without a temporary file.
+// gzip is always built in (zlib); zstd needs a build with MBO_HAVE_ZSTD
+// (make ZSTD=1).
+
+enum class Compression { None, Gzip, Zstd };
+
+// by the file's magic bytes; None for plain files and unreadable paths
+Compression detect_compression(const std::string &filename);
+
+const char *compression_name(Compression compression);
+
+// Decompression runs on its own thread into CHUNK_COUNT fixed buffers (triple
+// buffering), each cut at a line boundary so no row spans two chunks. Filled
+// and free chunk indexes go back and forth over two SpscRings, so the parser
+// works on one chunk while the next is being inflated. Symbols are interned,
+// records stay valid after their chunk is reused.
+class MboCompressedReader {
+public:
+    static constexpr size_t CHUNK_SIZE = 4 << 20;
+    static constexpr int CHUNK_COUNT = 3;
+
+    MboCompressedReader(const std::string &filename, Compression compression);
+    ~MboCompressedReader();
+
+    MboCompressedReader(const MboCompressedReader &) = delete;
+    MboCompressedReader &operator=(const MboCompressedReader &) = delete;
+
+    void skip_header();
+
+    // throws if the input turns out to be corrupt
+    bool next(MboRecord &rec);
+
+    size_t rows() const { return row_count; }
+
+    // compressed -> csv bytes, MB/s and how long each side waited on the other
+    void print_stats(std::ostream &out) const;
+
+private:
+    // filled ring markers besides chunk indexes
+    static constexpr int END_OF_INPUT = -1;
+    static constexpr int DECODE_ERROR = -2;
+
+    MappedFile file;
+    std::string filename;
+    Compression compression;
+    std::vector<std::vector<char>> chunks;
+    std::vector<size_t> chunk_used;
+    SpscRing<int> filled;
+    SpscRing<int> free_chunks;
+    std::atomic<bool> stop{false};
+    std::thread decoder;
+    std::string error; // set before DECODE_ERROR is pushed
+
+    // decoder side
+    uint64_t out_bytes = 0;
+    double decode_wall = 0;
+    double decoder_blocked = 0;
+
+    // parser side
+    int current = -1;
+    const char *cur = nullptr;
+    const char *end = nullptr;
+    bool done = false;
+    double parser_starved = 0;
+    size_t row_count = 0;
+    std::unordered_set<std::string> symbols;
+    std::string_view last_symbol;
+
+    template<typename Decoder>
+    void decode(Decoder &decoder);
+    void run_decoder();
+    bool take_free(int &index); // false once the reader is being destroyed
+    bool next_chunk();
+};
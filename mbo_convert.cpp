@@ -0,0 +1,93 @@
+// Converts an MBO csv file into the fixed-width binary format (mbo_binary.h).
+//
+//   ./mbo_convert mbo.csv mbo.mbob
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mbo_binary.h"
+#include "mbo_parser.h"
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <mbo.csv> <out.mbob>" << std::endl;
+        return 1;
+    }
+
+    try {
+        MboParser parser(argv[1]);
+        std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Error: cannot open " << argv[2] << std::endl;
+            return 1;
+        }
+
+        MboBinaryHeader header = {};
+        std::memcpy(header.magic, MBO_BINARY_MAGIC, sizeof(header.magic));
+        header.version = MBO_BINARY_VERSION;
+        header.record_size = sizeof(MboBinaryRecord);
+        header.records_offset = sizeof(MboBinaryHeader);
+        header.price_scale_digits = PRICE_SCALE_DIGITS;
+
+        // placeholder, rewritten once counts are known
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        std::unordered_map<std::string, uint16_t> symbol_ids;
+        std::vector<MboBinarySymbol> symbols;
+        MboRecord rec;
+
+        parser.skip_header();
+        while (parser.next(rec)) {
+            // a cut name could merge two symbols and a wrapped id would
+            // file records under the wrong one
+            if (rec.symbol.size() > sizeof(MboBinarySymbol::name)) {
+                throw std::runtime_error("symbol " + std::string(rec.symbol) + " is longer than " +
+                                         std::to_string(sizeof(MboBinarySymbol::name)) + " bytes");
+            }
+            std::string symbol(rec.symbol);
+            auto it = symbol_ids.find(symbol);
+            if (it == symbol_ids.end()) {
+                if (symbols.size() > UINT16_MAX) {
+                    throw std::runtime_error("more than " + std::to_string(UINT16_MAX + 1) +
+                                             " distinct symbols, the binary format indexes them with 16 bits");
+                }
+                MboBinarySymbol entry = {};
+                std::memcpy(entry.name, symbol.data(), symbol.size());
+                symbols.push_back(entry);
+                it = symbol_ids.emplace(symbol, static_cast<uint16_t>(symbols.size() - 1)).first;
+            }
+
+            MboBinaryRecord r = encode_binary_record(rec, it->second);
+
+            out.write(reinterpret_cast<const char *>(&r), sizeof(r));
+            header.record_count++;
+        }
+
+        header.symbols_offset = header.records_offset + header.record_count * sizeof(MboBinaryRecord);
+        header.symbol_count = static_cast<uint32_t>(symbols.size());
+        out.write(reinterpret_cast<const char *>(symbols.data()), symbols.size() * sizeof(MboBinarySymbol));
+
+        out.seekp(0);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        if (!out) {
+            std::cerr << "Error: write to " << argv[2] << " failed" << std::endl;
+            return 1;
+        }
+
+        std::cout << "Converted " << header.record_count << " records, " << header.symbol_count
+                  << " symbols: " << parser.bytes() << " -> "
+                  << header.symbols_offset + symbols.size() * sizeof(MboBinarySymbol) << " bytes" << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Embedding example for libmbp.a (mbp_engine.h): reconstructs an MBO input
+// in-process, no output file, and prints top-of-book statistics gathered by
+// a callback sink.
+//
+//   ./mbo_embed <mbo.csv|mbo.csv.gz|mbo.mbob> [--depth 1|10|50]
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "mbo_binary.h"
+#include "mbo_compressed.h"
+#include "mbo_parser.h"
+#include "mbp_engine.h"
+#include "parse_number.h"
+
+struct TopStats {
+    uint64_t rows = 0;
+    uint64_t two_sided = 0;
+    Price spread_sum = 0;
+    MbpLevel best_bid = {};
+    MbpLevel best_ask = {};
+    int64_t last_ts = 0;
+};
+
+template<typename Fn>
+static void open_and_run(const std::string &input, Fn &&run) {
+    Compression compression = detect_compression(input);
+    if (compression != Compression::None) {
+        MboCompressedReader reader(input, compression);
+        reader.skip_header();
+        run(reader);
+    } else if (is_mbo_binary(input)) {
+        MboBinaryReader reader(input);
+        run(reader);
+    } else {
+        MboParser parser(input);
+        parser.skip_header();
+        run(parser);
+    }
+}
+
+template<int Depth>
+static void embed(const std::string &input) {
+    TopStats stats;
+    uint64_t records = 0;
+
+    auto engine = make_mbp_engine<Depth>([&stats](const MbpSnapshot<Depth> &snap) {
+        MbpLevels bids = snap.bid_levels();
+        MbpLevels asks = snap.ask_levels();
+        stats.rows++;
+        stats.last_ts = snap.rec->ts_event;
+        if (!bids.empty() && !asks.empty()) {
+            stats.two_sided++;
+            stats.spread_sum += asks[0].px - bids[0].px;
+        }
+        stats.best_bid = bids.empty() ? MbpLevel{} : bids[0];
+        stats.best_ask = asks.empty() ? MbpLevel{} : asks[0];
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    open_and_run(input, [&](auto &reader) {
+        MboRecord rec;
+        while (reader.next(rec)) {
+            engine.on_mbo(rec);
+            records++;
+        }
+        engine.finish();
+    });
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+    std::cout << "records: " << records << ", MBP-" << Depth << " rows: " << stats.rows << std::endl;
+    std::cout << "last bbo: " << price_to_double(stats.best_bid.px) << " x " << stats.best_bid.sz << " / "
+              << price_to_double(stats.best_ask.px) << " x " << stats.best_ask.sz << " (ts_event "
+              << stats.last_ts << ")" << std::endl;
+    if (stats.two_sided > 0) {
+        std::cout << "mean spread: " << price_to_double(stats.spread_sum) / stats.two_sided << " over "
+                  << stats.two_sided << " two-sided rows" << std::endl;
+    }
+    std::cout << "time: " << seconds.count() << " s (" << records / seconds.count() / 1e6 << "M events/s)"
+              << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::string input;
+    int depth = MBP_DEPTH;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--depth" && i + 1 < argc && parse_number(argv[i + 1], depth)) {
+            i++;
+        } else if (input.empty() && arg[0] != '-') {
+            input = arg;
+        } else {
+            input.clear();
+            break;
+        }
+    }
+
+    if (input.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <mbo.csv|mbo.csv.gz|mbo.mbob> [--depth 1|10|50]" << std::endl;
+        return 1;
+    }
+
+    try {
+        with_mbp_depth(depth, [&](auto d) { embed<d.value>(input); });
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Writes a synthetic MBO csv (same columns as mbo.csv) for benchmarks, see
+// mbo_generator.h for the model.
+//
+//   ./mbo_gen out.csv [--rows N] [--orders N] [--depth TICKS] [--cancel-ratio R]
+//                     [--tfc-rate P] [--trade-n-rate P] [--instruments N] [--seed S]
+
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "mbo_generator.h"
+#include "parse_number.h"
+
+// flush threshold, one row is under 256 bytes
+static constexpr size_t WRITE_BUFFER_SIZE = 1 << 20;
+static constexpr size_t MAX_ROW_SIZE = 256;
+
+static char *put(char *out, std::string_view s) {
+    std::memcpy(out, s.data(), s.size());
+    return out + s.size();
+}
+
+static char *put_int(char *out, long long value) {
+    return std::to_chars(out, out + 24, value).ptr;
+}
+
+static char *put_uint(char *out, unsigned long long value) {
+    return std::to_chars(out, out + 24, value).ptr;
+}
+
+static char *encode_record(char *out, const MboRecord &rec) {
+    out = format_timestamp(out, rec.ts_recv);
+    *out++ = ',';
+    out = format_timestamp(out, rec.ts_event);
+    *out++ = ',';
+    out = put_int(out, rec.rtype);
+    *out++ = ',';
+    out = put_int(out, rec.publisher_id);
+    *out++ = ',';
+    out = put_int(out, rec.instrument_id);
+    *out++ = ',';
+    *out++ = rec.action;
+    *out++ = ',';
+    *out++ = rec.side;
+    *out++ = ',';
+    if (rec.action != 'R') out = format_price(out, rec.price, PRICE_SCALE_DIGITS);
+    *out++ = ',';
+    out = put_int(out, rec.size);
+    *out++ = ',';
+    out = put_int(out, rec.channel_id);
+    *out++ = ',';
+    out = put_uint(out, rec.order_id);
+    *out++ = ',';
+    out = put_int(out, rec.flags);
+    *out++ = ',';
+    out = put_int(out, rec.ts_in_delta);
+    *out++ = ',';
+    out = put_int(out, rec.sequence);
+    *out++ = ',';
+    out = put(out, rec.symbol);
+    *out++ = '\n';
+    return out;
+}
+
+static bool write_all(int fd, const char *p, size_t n) {
+    while (n > 0) {
+        ssize_t written = ::write(fd, p, n);
+        if (written <= 0) return false;
+        p += written;
+        n -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    std::string output;
+    GeneratorConfig config;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--rows" && i + 1 < argc && parse_number(argv[i + 1], config.rows)) {
+            i++;
+        } else if (arg == "--orders" && i + 1 < argc && parse_number(argv[i + 1], config.orders)) {
+            i++;
+        } else if (arg == "--depth" && i + 1 < argc && parse_number(argv[i + 1], config.depth)) {
+            i++;
+        } else if (arg == "--cancel-ratio" && i + 1 < argc && parse_number(argv[i + 1], config.cancel_ratio)) {
+            i++;
+        } else if (arg == "--tfc-rate" && i + 1 < argc && parse_number(argv[i + 1], config.tfc_rate)) {
+            i++;
+        } else if (arg == "--trade-n-rate" && i + 1 < argc && parse_number(argv[i + 1], config.trade_n_rate)) {
+            i++;
+        } else if (arg == "--instruments" && i + 1 < argc && parse_number(argv[i + 1], config.instruments)) {
+            i++;
+        } else if (arg == "--seed" && i + 1 < argc && parse_number(argv[i + 1], config.seed)) {
+            i++;
+        } else if (output.empty() && arg[0] != '-') {
+            output = arg;
+        } else {
+            output.clear();
+            break;
+        }
+    }
+
+    if (output.empty() || config.orders <= 0 || config.depth <= 0 || config.instruments <= 0 ||
+        config.cancel_ratio < 0 || config.tfc_rate < 0 || config.trade_n_rate < 0) {
+        std::cerr << "Usage: " << argv[0] << " <out.csv> [--rows N] [--orders N] [--depth TICKS] [--cancel-ratio R]"
+                  << " [--tfc-rate P] [--trade-n-rate P] [--instruments N] [--seed S]" << std::endl;
+        return 1;
+    }
+
+    int fd = ::open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: cannot open " << output << std::endl;
+        return 1;
+    }
+
+    std::vector<char> buffer(WRITE_BUFFER_SIZE);
+    char *out = put(buffer.data(), "ts_recv,ts_event,rtype,publisher_id,instrument_id,action,side,price,size,"
+                                   "channel_id,order_id,flags,ts_in_delta,sequence,symbol\n");
+    uint64_t bytes = 0;
+
+    MboGenerator generator(config);
+    MboRecord rec;
+    while (generator.next(rec)) {
+        if (out + MAX_ROW_SIZE > buffer.data() + buffer.size()) {
+            size_t n = out - buffer.data();
+            if (!write_all(fd, buffer.data(), n)) break;
+            bytes += n;
+            out = buffer.data();
+        }
+        out = encode_record(out, rec);
+    }
+
+    size_t n = out - buffer.data();
+    bool ok = write_all(fd, buffer.data(), n);
+    bytes += n;
+    ::close(fd);
+
+    if (!ok || generator.rows() != config.rows) {
+        std::cerr << "Error: write to " << output << " failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Generated " << generator.rows() << " rows, " << config.instruments << " instruments: "
+              << bytes << " bytes (" << output << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mbo_parser.h"
+#include "price.h"
+#include "timestamp.h"
+
+// Synthetic MBO stream for benchmarks. Every instrument starts with an R row,
+// fills its book to `orders` resting orders and then draws adds and full
+// cancels at cancel_ratio, with T-F-C sequences (trade against the front
+// order of the best opposite level) and side-N trades mixed in. Adds land up
+// to `depth` ticks from a slowly drifting mid, weighted towards the touch.
+// Output is deterministic for a given seed.
+struct GeneratorConfig {
+    uint64_t rows = 1000000;
+    int orders = 10000;         // target resting orders per instrument
+    int depth = 50;             // ticks from mid an add can land
+    double cancel_ratio = 1.0;  // cancels per add once the book is full
+    double tfc_rate = 0.01;     // share of events that are T-F-C sequences
+    double trade_n_rate = 0.002; // share of events that are side-N trades
+    int instruments = 1;
+    uint64_t seed = 1;
+};
+
+class MboGenerator {
+public:
+    explicit MboGenerator(const GeneratorConfig &config) : config(config), rng(config.seed) {
+        for (int i = 0; i < config.instruments; i++) {
+            Instrument inst;
+            inst.id = 1000 + static_cast<uint32_t>(i);
+            inst.mid_tick = 2000 + 500 * i; // 20.00, 25.00, ...
+            inst.symbol = "SYN" + std::to_string(i);
+            instruments.push_back(std::move(inst));
+        }
+    }
+
+    // false once config.rows records were produced
+    bool next(MboRecord &rec) {
+        if (emitted >= config.rows) return false;
+
+        if (pending.empty()) {
+            if (cleared < instruments.size()) {
+                emit_clear(instruments[cleared++]);
+            } else {
+                step(instruments[pick(instruments.size())]);
+            }
+        }
+
+        rec = pending.front();
+        pending.pop_front();
+        emitted++;
+        return true;
+    }
+
+    uint64_t rows() const { return emitted; }
+
+private:
+    // one cent
+    static constexpr Price TICK = PRICE_SCALE / 100;
+    // 2025-07-17T13:30:00Z
+    static constexpr int64_t START_NS = (days_from_civil(2025, 7, 17) * SECONDS_PER_DAY + 13 * 3600 + 30 * 60) * NANOS_PER_SECOND;
+
+    struct GenOrder {
+        uint64_t order_id;
+        char side;
+        int64_t tick;
+        int size;
+        uint32_t live_pos;  // in Instrument::live
+        uint32_t level_pos; // in its level vector
+    };
+
+    struct Instrument {
+        uint32_t id;
+        std::string symbol;
+        int64_t mid_tick;
+        std::vector<uint32_t> live;                      // slots of resting orders
+        std::map<int64_t, std::vector<uint32_t>> levels[2]; // bids, asks by tick
+    };
+
+    GeneratorConfig config;
+    std::mt19937_64 rng;
+    std::vector<Instrument> instruments; // not resized after construction, records point at symbol
+    std::vector<GenOrder> slab;
+    std::vector<uint32_t> free_slots;
+    std::deque<MboRecord> pending;
+    size_t cleared = 0;
+    uint64_t emitted = 0;
+    uint64_t next_order_id = 1000000;
+    int64_t ts_event = START_NS;
+    uint32_t sequence = 1000;
+
+    double uniform() { return (rng() >> 11) * 0x1.0p-53; }
+    size_t pick(size_t n) { return static_cast<size_t>(rng() % n); }
+
+    MboRecord make(const Instrument &inst, char action, char side, Price price, int size, uint64_t order_id) {
+        MboRecord rec;
+        rec.ts_event = ts_event;
+        rec.ts_recv = ts_event + 150 + static_cast<int64_t>(pick(64));
+        rec.rtype = 160;
+        rec.publisher_id = 2;
+        rec.instrument_id = inst.id;
+        rec.action = action;
+        rec.side = side;
+        rec.price = price;
+        rec.size = size;
+        rec.channel_id = 0;
+        rec.order_id = order_id;
+        rec.flags = action == 'R' ? 8 : 130;
+        rec.ts_in_delta = 165000 + static_cast<int32_t>(pick(2000));
+        rec.sequence = sequence;
+        rec.symbol = inst.symbol;
+        return rec;
+    }
+
+    void advance_clock() {
+        // exponential gaps, 20us mean
+        ts_event += 1 + static_cast<int64_t>(-std::log(1.0 - uniform()) * 20000.0);
+        sequence++;
+    }
+
+    void emit_clear(Instrument &inst) {
+        advance_clock();
+        pending.push_back(make(inst, 'R', 'N', 0, 0, 0));
+    }
+
+    void step(Instrument &inst) {
+        advance_clock();
+
+        if (uniform() < 0.001) {
+            inst.mid_tick += uniform() < 0.5 ? -1 : 1;
+        }
+
+        double r = uniform();
+        if (r < config.tfc_rate && trade(inst)) return;
+        if (r < config.tfc_rate + config.trade_n_rate) {
+            pending.push_back(make(inst, 'T', 'N', inst.mid_tick * TICK, 1 + static_cast<int>(pick(100)), 0));
+            return;
+        }
+
+        size_t live = inst.live.size();
+        size_t target = static_cast<size_t>(config.orders);
+        bool cancel;
+        if (live == 0) {
+            cancel = false;
+        } else if (live < target && emitted < target * instruments.size() * 2) {
+            cancel = false; // warm-up fill
+        } else if (live > 2 * target) {
+            cancel = true;
+        } else {
+            cancel = uniform() < config.cancel_ratio / (1.0 + config.cancel_ratio);
+        }
+
+        if (cancel) {
+            uint32_t slot = inst.live[pick(live)];
+            const GenOrder &o = slab[slot];
+            pending.push_back(make(inst, 'C', o.side, o.tick * TICK, o.size, o.order_id));
+            remove(inst, slot);
+        } else {
+            add(inst);
+        }
+    }
+
+    void add(Instrument &inst) {
+        char side = uniform() < 0.5 ? 'B' : 'A';
+        int64_t k = static_cast<int64_t>(-std::log(1.0 - uniform()) * config.depth / 4.0);
+        if (k >= config.depth) k = config.depth - 1;
+
+        int64_t tick = side == 'B' ? inst.mid_tick - 1 - k : inst.mid_tick + 1 + k;
+        int size = 100 * (1 + static_cast<int>(pick(10)));
+
+        uint32_t slot;
+        if (!free_slots.empty()) {
+            slot = free_slots.back();
+            free_slots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(slab.size());
+            slab.push_back(GenOrder());
+        }
+
+        std::vector<uint32_t> &level = inst.levels[side == 'A'][tick];
+        slab[slot] = { next_order_id++, side, tick, size,
+                       static_cast<uint32_t>(inst.live.size()), static_cast<uint32_t>(level.size()) };
+        inst.live.push_back(slot);
+        level.push_back(slot);
+
+        pending.push_back(make(inst, 'A', side, tick * TICK, size, slab[slot].order_id));
+    }
+
+    // T on the aggressor side, F + C for the front order of the best opposite level
+    bool trade(Instrument &inst) {
+        char aggressor = uniform() < 0.5 ? 'B' : 'A';
+        auto &book = inst.levels[aggressor == 'B']; // buyer lifts asks
+        if (book.empty()) return false;
+
+        auto best = aggressor == 'B' ? book.begin() : std::prev(book.end());
+        uint32_t slot = best->second.front();
+        const GenOrder &o = slab[slot];
+        Price price = o.tick * TICK;
+
+        pending.push_back(make(inst, 'T', aggressor, price, o.size, 0));
+        pending.push_back(make(inst, 'F', o.side, price, o.size, o.order_id));
+        pending.push_back(make(inst, 'C', o.side, price, o.size, o.order_id));
+        remove(inst, slot);
+        return true;
+    }
+
+    void remove(Instrument &inst, uint32_t slot) {
+        GenOrder &o = slab[slot];
+
+        uint32_t moved = inst.live.back();
+        inst.live[o.live_pos] = moved;
+        slab[moved].live_pos = o.live_pos;
+        inst.live.pop_back();
+
+        auto &book = inst.levels[o.side == 'A'];
+        auto it = book.find(o.tick);
+        std::vector<uint32_t> &level = it->second;
+        // swap-remove, so the "front" order a trade hits is only roughly the oldest
+        uint32_t last = level.back();
+        level[o.level_pos] = last;
+        slab[last].level_pos = o.level_pos;
+        level.pop_back();
+        if (level.empty()) book.erase(it);
+
+        free_slots.push_back(slot);
+    }
+};
@@ -0,0 +1,130 @@
+#include "mbo_parser.h"
+
+#include <charconv>
+#include <stdexcept>
+
+#include "timestamp.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+MboParser::MboParser(const std::string &filename) : file(filename) {
+    cur = file.data();
+    end = file.data() + file.size();
+}
+
+void MboParser::seek(size_t offset) {
+    if (offset > file.size() || (offset > 0 && file.data()[offset - 1] != '\n')) {
+        throw std::runtime_error("seek to " + std::to_string(offset) + " is not a row boundary");
+    }
+    cur = file.data() + offset;
+}
+
+void MboParser::skip_header() {
+    std::string_view fields[MBO_FIELD_COUNT];
+    int field_count = 0;
+    if (cur < end) {
+        cur = split_mbo_line(cur, end, fields, field_count);
+    }
+}
+
+// PARSE HELPERS
+template<typename T>
+static T parse_int(std::string_view s) {
+    T value = 0;
+    std::from_chars(s.data(), s.data() + s.size(), value);
+    return value;
+}
+
+bool MboParser::next(MboRecord &rec) {
+    std::string_view fields[MBO_FIELD_COUNT];
+    int field_count = 0;
+
+    // skip blank lines, stop on a complete row
+    while (cur < end) {
+        cur = split_mbo_line(cur, end, fields, field_count);
+        if (field_count >= MBO_FIELD_COUNT - 1) break;
+    }
+    if (field_count < MBO_FIELD_COUNT - 1) return false;
+
+    decode_mbo_fields(fields, field_count, rec);
+
+    row_count++;
+    return true;
+}
+
+void decode_mbo_fields(const std::string_view *fields, int field_count, MboRecord &rec) {
+    rec.ts_recv = parse_timestamp(fields[0]);
+    rec.ts_event = parse_timestamp(fields[1]);
+    rec.rtype = parse_int<uint8_t>(fields[2]);
+    rec.publisher_id = parse_int<uint16_t>(fields[3]);
+    rec.instrument_id = parse_int<uint32_t>(fields[4]);
+    rec.action = fields[5].empty() ? '\0' : fields[5][0];
+    rec.side = fields[6].empty() ? '\0' : fields[6][0];
+    rec.price = parse_price(fields[7]);
+    rec.size = parse_int<int>(fields[8]);
+    rec.channel_id = parse_int<uint8_t>(fields[9]);
+    rec.order_id = parse_int<uint64_t>(fields[10]);
+    rec.flags = parse_int<uint8_t>(fields[11]);
+    rec.ts_in_delta = parse_int<int32_t>(fields[12]);
+    rec.sequence = parse_int<uint32_t>(fields[13]);
+    rec.symbol = field_count > 14 ? fields[14] : std::string_view();
+}
+
+// Field boundaries are ',' and '\n'. The SSE2 path compares 16 bytes at a time
+// and walks the resulting bitmask, the scalar loop handles the tail.
+const char *split_mbo_line(const char *p, const char *end, std::string_view *fields, int &field_count) {
+    const char *field_start = p;
+    field_count = 0;
+
+    auto close_field = [&](const char *pos) {
+        if (field_count < MBO_FIELD_COUNT) {
+            fields[field_count++] = std::string_view(field_start, pos - field_start);
+        }
+        field_start = pos + 1;
+    };
+
+    auto close_line = [&](const char *pos) {
+        // tolerate CRLF line endings
+        const char *field_end = (pos > field_start && pos[-1] == '\r') ? pos - 1 : pos;
+        close_field(field_end);
+        return pos + 1;
+    };
+
+#ifdef __SSE2__
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    while (p + 16 <= end) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, comma), _mm_cmpeq_epi8(chunk, newline))));
+
+        while (mask) {
+            const char *pos = p + __builtin_ctz(mask);
+            if (*pos == '\n') {
+                return close_line(pos);
+            }
+            close_field(pos);
+            mask &= mask - 1;
+        }
+        p += 16;
+    }
+#endif
+
+    for (; p < end; p++) {
+        if (*p == '\n') {
+            return close_line(p);
+        }
+        if (*p == ',') {
+            close_field(p);
+        }
+    }
+
+    // last line without trailing newline
+    if (field_start < end || field_count > 0) {
+        close_line(end);
+    }
+    return end;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "mapped_file.h"
+#include "price.h"
+
+// number of comma separated fields in one MBO csv row
+constexpr int MBO_FIELD_COUNT = 15;
+
+// Typed, fixed-layout MBO record, shared by the csv and binary inputs.
+// Timestamps are epoch ns; symbol points into the input (mapped csv or the
+// binary symbol table), so a record stays valid as long as its reader lives.
+struct MboRecord {
+    int64_t ts_recv;
+    int64_t ts_event;
+    uint8_t rtype;
+    uint16_t publisher_id;
+    uint32_t instrument_id;
+    char action;
+    char side;
+    Price price;
+    int size;
+    uint8_t channel_id;
+    uint64_t order_id;
+    uint8_t flags;
+    int32_t ts_in_delta;
+    uint32_t sequence;
+    std::string_view symbol;
+};
+
+// Memory-mapped MBO csv reader. Rows are split with a SIMD delimiter scan and
+// decoded straight into MboRecord, no heap allocation per row.
+class MboParser {
+public:
+    explicit MboParser(const std::string &filename);
+
+    void skip_header();
+    bool next(MboRecord &rec);
+
+    size_t bytes() const { return file.size(); }
+    size_t rows() const { return row_count; }
+
+    // byte position of the next row, and back (for checkpoint resume)
+    size_t offset() const { return cur - file.data(); }
+    void seek(size_t offset);
+
+private:
+    MappedFile file;
+    const char *cur = nullptr;
+    const char *end = nullptr;
+    size_t row_count = 0;
+};
+
+// Splits one line starting at p into fields, returns pointer past the line.
+const char *split_mbo_line(const char *p, const char *end, std::string_view *fields, int &field_count);
+
+// Decodes the fields of one csv row into rec.
+void decode_mbo_fields(const std::string_view *fields, int field_count, MboRecord &rec);
@@ -0,0 +1,265 @@
+// Book-at-time-T queries over an MBO input through a sidecar replay index
+// (replay_index.h).
+//
+//   ./mbo_query index <mbo.csv|mbo.mbob> [--index <path>] [--every N] [--interval-ms MS]
+//                     [--book map|ladder] [--tick <price>] [--ladder-window <ticks>]
+//   ./mbo_query query <mbo.csv|mbo.mbob> [<ts> ...] [--times <file>] [--index <path>]
+//                     [--depth N] [--threads N] [--book map|ladder] [--tick <price>] [--ladder-window <ticks>]
+//
+// The index defaults to <input>.idx. Timestamps are ISO-8601 like the input
+// ("2025-07-17T08:05:03.360677248Z") or integer epoch ns, one per argument or
+// per line of --times. Each query restores the nearest preceding checkpoint
+// and replays only the gap; independent queries run on --threads workers
+// (default: all cores). Output is csv on stdout, one row per query in input
+// order: query_ts,ts_event,sequence,records then bid/ask px,sz,ct per level
+// as in output.csv.
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "book_side.h"
+#include "checkpoint.h"
+#include "mbo_binary.h"
+#include "mbo_parser.h"
+#include "parse_number.h"
+#include "replay_index.h"
+#include "timestamp.h"
+
+// --interval-ms bound: the span in ns, added to a ts_event, stays in int64
+static constexpr int64_t MAX_INTERVAL_MS = INT64_MAX / 2 / 1000000;
+
+static void print_usage(const char *prog) {
+    std::cerr << "Usage: " << prog << " index <mbo.csv|mbo.mbob> [--index <path>] [--every N] [--interval-ms MS]"
+              << " [--book map|ladder] [--tick <price>] [--ladder-window <ticks>]\n"
+              << "       " << prog << " query <mbo.csv|mbo.mbob> [<ts> ...] [--times <file>] [--index <path>]"
+              << " [--depth N] [--threads N] [--book map|ladder] [--tick <price>] [--ladder-window <ticks>]" << std::endl;
+}
+
+// ISO-8601 or integer epoch ns
+static bool parse_query_ts(const std::string &text, int64_t &ts) {
+    if (text.find('T') != std::string::npos) {
+        ts = parse_timestamp(text);
+        return ts != 0;
+    }
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), ts);
+    return ec == std::errc() && ptr == text.data() + text.size();
+}
+
+static char *put_int(char *out, long long value) {
+    return std::to_chars(out, out + 24, value).ptr;
+}
+
+static void write_result(std::string &out, const BookAtTime &result, int depth) {
+    char buffer[128];
+    char *p = buffer;
+    p = format_timestamp(p, result.query_ts);
+    *p++ = ',';
+    if (result.records > 0) p = format_timestamp(p, result.ts_event);
+    *p++ = ',';
+    p = put_int(p, result.sequence);
+    *p++ = ',';
+    p = put_int(p, static_cast<long long>(result.records));
+    out.append(buffer, p - buffer);
+
+    for (int i = 0; i < depth; i++) {
+        for (const std::vector<MbpLevel> *side : { &result.bids, &result.asks }) {
+            if (i >= static_cast<int>(side->size())) {
+                out += ",,0,0";
+                continue;
+            }
+            const MbpLevel &level = (*side)[i];
+            p = buffer;
+            *p++ = ',';
+            p = format_price(p, level.px);
+            *p++ = ',';
+            p = put_int(p, level.sz);
+            *p++ = ',';
+            p = put_int(p, level.ct);
+            out.append(buffer, p - buffer);
+        }
+    }
+    out += '\n';
+}
+
+struct QueryOptions {
+    std::string input;
+    std::string index_path;
+    ReplayIndexConfig index;
+    BookConfig book;
+    std::vector<int64_t> times;
+    int depth = MBP_DEPTH;
+    int threads = 0;
+};
+
+template<template<bool> class BookSide>
+static int build_index(const QueryOptions &options) {
+    auto start = std::chrono::steady_clock::now();
+    size_t entries;
+    if (is_mbo_binary(options.input)) {
+        MboBinaryReader reader(options.input);
+        entries = build_replay_index<BookSide>(reader, CheckpointInput::Binary, options.index_path, options.index, options.book);
+    } else {
+        MboParser parser(options.input);
+        parser.skip_header();
+        entries = build_replay_index<BookSide>(parser, CheckpointInput::Csv, options.index_path, options.index, options.book);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cerr << "Indexed " << options.input << ": " << entries << " entries (" << options.index_path << ") in "
+              << elapsed.count() << " seconds" << std::endl;
+    return 0;
+}
+
+// each worker owns a reader; queries are handed out through one counter
+template<template<bool> class BookSide, typename Reader>
+static void answer_queries(const QueryOptions &options, const ReplayIndex &index, std::vector<std::string> &rows) {
+    std::atomic<size_t> next(0);
+    std::vector<std::string> errors(options.threads);
+
+    auto worker = [&](int id) {
+        try {
+            Reader reader(options.input);
+            while (true) {
+                size_t i = next.fetch_add(1);
+                if (i >= options.times.size()) break;
+                BookAtTime result = query_book_at<BookSide>(index, reader, options.times[i], options.depth, options.book);
+                write_result(rows[i], result, options.depth);
+            }
+        } catch (const std::exception &e) {
+            errors[id] = e.what();
+            next = options.times.size();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < options.threads; t++) workers.emplace_back(worker, t);
+    worker(0);
+    for (std::thread &t : workers) t.join();
+
+    for (const std::string &error : errors) {
+        if (!error.empty()) throw std::runtime_error(error);
+    }
+}
+
+template<template<bool> class BookSide>
+static int run_queries(const QueryOptions &options) {
+    auto start = std::chrono::steady_clock::now();
+    ReplayIndex index(options.index_path);
+
+    CheckpointInput input_format = is_mbo_binary(options.input) ? CheckpointInput::Binary : CheckpointInput::Csv;
+    MappedFile input(options.input);
+    if (index.input_format() != input_format || index.input_size() != input.size()) {
+        throw std::runtime_error(options.index_path + " was built for a different input");
+    }
+
+    std::vector<std::string> rows(options.times.size());
+    if (input_format == CheckpointInput::Binary) {
+        answer_queries<BookSide, MboBinaryReader>(options, index, rows);
+    } else {
+        answer_queries<BookSide, MboParser>(options, index, rows);
+    }
+
+    std::string out = "query_ts,ts_event,sequence,records";
+    for (int i = 0; i < options.depth; i++) {
+        std::string id = (i < 10 ? "0" : "") + std::to_string(i);
+        for (const char *name : { ",bid_px_", ",bid_sz_", ",bid_ct_", ",ask_px_", ",ask_sz_", ",ask_ct_" }) {
+            out += name + id;
+        }
+    }
+    out += '\n';
+    std::cout << out;
+    for (const std::string &row : rows) std::cout << row;
+    std::cout.flush();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cerr << "Answered " << options.times.size() << " queries on " << options.threads << " threads in "
+              << elapsed.count() << " seconds" << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::string mode = argv[1];
+    std::string book_backend = "map";
+    QueryOptions options;
+    options.input = argv[2];
+
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        int64_t ts, interval_ms;
+        if (arg == "--index" && i + 1 < argc) {
+            options.index_path = argv[++i];
+        } else if (arg == "--every" && i + 1 < argc && parse_number(argv[i + 1], options.index.every)) {
+            i++;
+        } else if (arg == "--interval-ms" && i + 1 < argc && parse_number(argv[i + 1], interval_ms) &&
+                   interval_ms >= 0 && interval_ms <= MAX_INTERVAL_MS) {
+            options.index.interval_ns = interval_ms * 1000000;
+            i++;
+        } else if (arg == "--book" && i + 1 < argc) {
+            book_backend = argv[++i];
+        } else if (arg == "--tick" && i + 1 < argc) {
+            options.book.tick_size = parse_price(argv[++i]);
+        } else if (arg == "--ladder-window" && i + 1 < argc && parse_number(argv[i + 1], options.book.ladder_window)) {
+            i++;
+        } else if (arg == "--depth" && i + 1 < argc && parse_number(argv[i + 1], options.depth)) {
+            i++;
+        } else if (arg == "--threads" && i + 1 < argc && parse_number(argv[i + 1], options.threads)) {
+            i++;
+        } else if (arg == "--times" && i + 1 < argc) {
+            std::ifstream file(argv[++i]);
+            if (!file) {
+                std::cerr << "Error: cannot open " << argv[i] << std::endl;
+                return 1;
+            }
+            std::string line;
+            while (std::getline(file, line)) {
+                if (line.empty()) continue;
+                if (!parse_query_ts(line, ts)) {
+                    std::cerr << "Error: bad timestamp " << line << std::endl;
+                    return 1;
+                }
+                options.times.push_back(ts);
+            }
+        } else if (mode == "query" && arg[0] != '-' && parse_query_ts(arg, ts)) {
+            options.times.push_back(ts);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.index_path.empty()) {
+        options.index_path = options.input + ".idx";
+    }
+    if (options.threads <= 0) {
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    if ((mode != "index" && mode != "query") || (book_backend != "map" && book_backend != "ladder") ||
+        (options.index.every == 0 && options.index.interval_ns <= 0) || options.depth <= 0 ||
+        options.book.tick_size <= 0 || options.book.ladder_window <= 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        if (mode == "index") {
+            return book_backend == "ladder" ? build_index<LadderBookSide>(options) : build_index<MapBookSide>(options);
+        }
+        return book_backend == "ladder" ? run_queries<LadderBookSide>(options) : run_queries<MapBookSide>(options);
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,164 @@
+// Replays an MBO csv file into a streaming reconstruction_hitaesh at a fixed
+// rate, for measuring per-event latency without an external feed.
+//
+//   ./mbo_replay mbo.csv <-|tcp:PORT|udp:PORT> [--rate rows_per_sec] [--stamp]
+//
+// tcp connects to 127.0.0.1:PORT (retrying until the engine listens), udp
+// sends whole lines per datagram and ends with an empty one. --rate 0 (the
+// default) sends as fast as possible. --stamp overwrites ts_recv with the send
+// time so the engine's --latency report is end to end.
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "mapped_file.h"
+#include "mbo_stream.h"
+#include "parse_number.h"
+#include "timestamp.h"
+
+// datagrams stay under a typical loopback-friendly size
+static constexpr size_t MAX_DATAGRAM = 8192;
+
+static bool send_all(int fd, const char *p, size_t n) {
+    while (n > 0) {
+        ssize_t sent = ::write(fd, p, n);
+        if (sent <= 0) return false;
+        p += sent;
+        n -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+static int connect_endpoint(const StreamEndpoint &endpoint) {
+    if (endpoint.transport == StreamTransport::Stdin) {
+        return STDOUT_FILENO;
+    }
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(endpoint.port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    bool udp = endpoint.transport == StreamTransport::Udp;
+    for (int attempt = 0; attempt < 500; attempt++) {
+        int fd = ::socket(AF_INET, udp ? SOCK_DGRAM : SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0) {
+            return fd;
+        }
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+int main(int argc, char *argv[]) {
+    std::string input;
+    std::string target;
+    double rate = 0;
+    bool stamp = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--rate" && i + 1 < argc && parse_number(argv[i + 1], rate)) {
+            i++;
+        } else if (arg == "--stamp") {
+            stamp = true;
+        } else if (input.empty() && arg[0] != '-') {
+            input = arg;
+        } else if (target.empty()) {
+            target = arg;
+        } else {
+            input.clear();
+            break;
+        }
+    }
+
+    StreamEndpoint endpoint;
+    if (input.empty() || !parse_stream_source(target, endpoint) || !(rate >= 0)) {
+        std::cerr << "Usage: " << argv[0] << " <mbo.csv> <-|tcp:PORT|udp:PORT> [--rate rows_per_sec] [--stamp]" << std::endl;
+        return 1;
+    }
+
+    try {
+        MappedFile file(input);
+        int fd = connect_endpoint(endpoint);
+        if (fd < 0) {
+            std::cerr << "Error: cannot connect to " << target << std::endl;
+            return 1;
+        }
+        bool udp = endpoint.transport == StreamTransport::Udp;
+
+        const char *p = file.data();
+        const char *end = p + file.size();
+        std::vector<char> batch;
+        size_t rows = 0;
+        bool header = true;
+
+        auto start = std::chrono::steady_clock::now();
+        auto interval = std::chrono::duration<double>(rate > 0 ? 1.0 / rate : 0);
+
+        while (p < end) {
+            // every row that is due goes out in one write
+            batch.clear();
+            auto now = std::chrono::steady_clock::now();
+            while (p < end && batch.size() < MAX_DATAGRAM / 2) {
+                if (!header && rate > 0 && start + interval * static_cast<double>(rows) > now) break;
+
+                const char *nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+                const char *line_end = nl ? nl + 1 : end;
+
+                const char *comma = static_cast<const char *>(std::memchr(p, ',', line_end - p));
+                if (stamp && !header && comma) {
+                    char ts[TIMESTAMP_TEXT_SIZE + 1];
+                    int64_t sent = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count();
+                    char *ts_end = format_timestamp(ts, sent);
+                    batch.insert(batch.end(), ts, ts_end);
+                    batch.insert(batch.end(), comma, line_end);
+                } else {
+                    batch.insert(batch.end(), p, line_end);
+                }
+                if (!nl) batch.push_back('\n');
+
+                rows += header ? 0 : 1;
+                header = false;
+                p = line_end;
+            }
+
+            if (batch.empty()) {
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    interval * static_cast<double>(rows)));
+                continue;
+            }
+            if (!send_all(fd, batch.data(), batch.size())) {
+                std::cerr << "Error: send to " << target << " failed" << std::endl;
+                return 1;
+            }
+        }
+
+        if (udp) {
+            ::send(fd, "", 0, 0);
+        }
+        if (fd != STDOUT_FILENO) {
+            ::close(fd);
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cerr << "Replayed " << rows << " rows in " << seconds << " s (" << rows / seconds << " rows/s)" << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
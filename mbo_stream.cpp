@@ -0,0 +1,159 @@
+#include "mbo_stream.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// initial receive buffer, grows if a line does not fit
+static constexpr size_t STREAM_BUFFER_SIZE = 1 << 16;
+
+bool parse_stream_source(const std::string &spec, StreamEndpoint &endpoint) {
+    if (spec == "-") {
+        endpoint.transport = StreamTransport::Stdin;
+        return true;
+    }
+
+    std::string port;
+    if (spec.compare(0, 4, "tcp:") == 0) {
+        endpoint.transport = StreamTransport::Tcp;
+        port = spec.substr(4);
+    } else if (spec.compare(0, 4, "udp:") == 0) {
+        endpoint.transport = StreamTransport::Udp;
+        port = spec.substr(4);
+    } else {
+        return false;
+    }
+
+    if (port.empty() || port.size() > 5 || port.find_first_not_of("0123456789") != std::string::npos) return false;
+    unsigned long value = std::stoul(port);
+    if (value == 0 || value > 65535) return false;
+    endpoint.port = static_cast<uint16_t>(value);
+    return true;
+}
+
+static sockaddr_in loopback_address(uint16_t port) {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+MboStreamReader::MboStreamReader(const StreamEndpoint &endpoint) : buffer(STREAM_BUFFER_SIZE) {
+    if (endpoint.transport == StreamTransport::Stdin) {
+        fd = STDIN_FILENO;
+        return;
+    }
+
+    sockaddr_in addr = loopback_address(endpoint.port);
+    udp = endpoint.transport == StreamTransport::Udp;
+
+    int sock = ::socket(AF_INET, udp ? SOCK_DGRAM : SOCK_STREAM, 0);
+    if (sock < 0) {
+        throw std::runtime_error("cannot create socket");
+    }
+    int reuse = 1;
+    ::setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    if (::bind(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        ::close(sock);
+        throw std::runtime_error("cannot bind port " + std::to_string(endpoint.port));
+    }
+
+    if (udp) {
+        fd = sock;
+        return;
+    }
+
+    listen_fd = sock;
+    if (::listen(listen_fd, 1) != 0) {
+        throw std::runtime_error("cannot listen on port " + std::to_string(endpoint.port));
+    }
+    fd = ::accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+        throw std::runtime_error("accept failed on port " + std::to_string(endpoint.port));
+    }
+}
+
+MboStreamReader::~MboStreamReader() {
+    if (fd >= 0 && fd != STDIN_FILENO) ::close(fd);
+    if (listen_fd >= 0) ::close(listen_fd);
+}
+
+bool MboStreamReader::ready() const {
+    return std::memchr(buffer.data() + begin, '\n', end - begin) != nullptr;
+}
+
+StreamStatus MboStreamReader::next(MboRecord &rec, int timeout_ms) {
+    while (true) {
+        if (decode_line(rec)) return StreamStatus::Record;
+        if (eof) return StreamStatus::End;
+        if (!receive(timeout_ms)) return StreamStatus::Timeout;
+    }
+}
+
+// decodes the next complete data line, the unterminated tail only at eof
+bool MboStreamReader::decode_line(MboRecord &rec) {
+    std::string_view fields[MBO_FIELD_COUNT];
+    int field_count = 0;
+
+    while (begin < end) {
+        const char *p = buffer.data() + begin;
+        const char *nl = static_cast<const char *>(std::memchr(p, '\n', end - begin));
+        if (!nl && !eof) return false;
+
+        const char *line_end = nl ? nl + 1 : buffer.data() + end;
+        split_mbo_line(p, line_end, fields, field_count);
+        begin = line_end - buffer.data();
+
+        if (field_count < MBO_FIELD_COUNT - 1 || *p < '0' || *p > '9') continue;
+
+        decode_mbo_fields(fields, field_count, rec);
+        rec.symbol = *symbols.emplace(rec.symbol).first;
+        row_count++;
+        return true;
+    }
+    return false;
+}
+
+// false on timeout; eof is set when the peer is done
+bool MboStreamReader::receive(int timeout_ms) {
+    pollfd pfd = { fd, POLLIN, 0 };
+    int ready_count = ::poll(&pfd, 1, timeout_ms);
+    if (ready_count == 0) return false;
+    if (ready_count < 0) {
+        throw std::runtime_error("poll failed on stream input");
+    }
+
+    // keep the partial line, make room behind it
+    if (begin > 0) {
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+    }
+    if (buffer.size() - end < STREAM_BUFFER_SIZE / 2) {
+        buffer.resize(buffer.size() * 2);
+    }
+
+    ssize_t n = udp ? ::recv(fd, buffer.data() + end, buffer.size() - end - 1, 0)
+                    : ::read(fd, buffer.data() + end, buffer.size() - end);
+    if (n < 0) {
+        throw std::runtime_error("read failed on stream input");
+    }
+    if (n == 0) {
+        eof = true;
+        return true;
+    }
+
+    end += static_cast<size_t>(n);
+    // a datagram always ends a line
+    if (udp && buffer[end - 1] != '\n') {
+        buffer[end++] = '\n';
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "mbo_parser.h"
+
+// Live MBO csv input. A source is "-" (stdin), "tcp:PORT" (listen on
+// 127.0.0.1:PORT and take one connection) or "udp:PORT" (bind 127.0.0.1:PORT,
+// one or more whole lines per datagram, an empty datagram ends the stream).
+
+enum class StreamTransport { Stdin, Tcp, Udp };
+
+struct StreamEndpoint {
+    StreamTransport transport = StreamTransport::Stdin;
+    uint16_t port = 0;
+};
+
+// false if spec is not one of the forms above
+bool parse_stream_source(const std::string &spec, StreamEndpoint &endpoint);
+
+enum class StreamStatus { Record, Timeout, End };
+
+// Incremental reader: lines are decoded as soon as they are complete. The
+// header (any line not starting with a digit) is skipped. Symbols are interned,
+// so records stay valid after the receive buffer is reused.
+class MboStreamReader {
+public:
+    explicit MboStreamReader(const StreamEndpoint &endpoint);
+    ~MboStreamReader();
+
+    MboStreamReader(const MboStreamReader &) = delete;
+    MboStreamReader &operator=(const MboStreamReader &) = delete;
+
+    // true if a complete line is already buffered, next() will not block
+    bool ready() const;
+
+    // waits up to timeout_ms for the next record (-1 waits indefinitely)
+    StreamStatus next(MboRecord &rec, int timeout_ms);
+
+    size_t rows() const { return row_count; }
+
+private:
+    int listen_fd = -1;
+    int fd = -1;
+    bool udp = false;
+    bool eof = false;
+    std::vector<char> buffer;
+    size_t begin = 0;
+    size_t end = 0;
+    size_t row_count = 0;
+    std::unordered_set<std::string> symbols;
+
+    bool decode_line(MboRecord &rec);
+    bool receive(int timeout_ms);
+};
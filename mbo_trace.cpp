@@ -0,0 +1,217 @@
+// Offline decoder for trace files (trace.h): renders one thread's ring as
+// the text the old debug logging wrote, event log and MBP table.
+//
+//   ./mbo_trace <trace.bin> [--logs logs.txt] [--mbp-logs mbp_logs.txt]
+//
+// Prints per-type record counts and, if the ring wrapped, how many of the
+// oldest records were overwritten. Level records whose snapshot was lost to
+// the wrap are skipped.
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "mapped_file.h"
+#include "price.h"
+#include "trace.h"
+
+// column widths of mbp_logs.txt
+static const int COL_WIDTH_ORDER_ID = 10;
+static const int COL_WIDTH_ACTION = 7;
+static const int COL_WIDTH_SIDE = 7;
+static const int COL_WIDTH_DEPTH = 7;
+static const int COL_WIDTH_PRICE = 12;
+static const int COL_WIDTH_SIZE = 10;
+static const int COL_WIDTH_COUNT = 7;
+
+static const char *TYPE_NAMES[] = { "", "top_of_book", "add", "cancel", "tfc", "eof_pending", "missed_top", "snapshot", "level" };
+static constexpr int TYPE_COUNT = 9;
+
+static void write_mbp_header(std::ostream &out, int depth) {
+    out << std::left
+        << std::setw(COL_WIDTH_ORDER_ID) << "order_id"
+        << std::setw(COL_WIDTH_ACTION) << "action"
+        << std::setw(COL_WIDTH_SIDE) << "side"
+        << std::setw(COL_WIDTH_DEPTH) << "depth"
+        << std::setw(COL_WIDTH_PRICE) << "price"
+        << std::setw(COL_WIDTH_SIZE) << "size";
+
+    for (int i = 0; i < depth; ++i) {
+        std::ostringstream bid_px, bid_sz, bid_ct, ask_px, ask_sz, ask_ct;
+        bid_px << "bid_px_" << i << std::setw(5);
+        bid_sz << "bid_sz_" << i << std::setw(5);
+        bid_ct << "bid_ct_" << i << std::setw(5);
+        ask_px << "ask_px_" << i << std::setw(5);
+        ask_sz << "ask_sz_" << i << std::setw(5);
+        ask_ct << "ask_ct_" << i << std::setw(5);
+
+        out << std::setw(COL_WIDTH_PRICE) << bid_px.str()
+            << std::setw(COL_WIDTH_SIZE) << bid_sz.str()
+            << std::setw(COL_WIDTH_COUNT) << bid_ct.str()
+            << "\t"
+            << std::setw(COL_WIDTH_PRICE) << ask_px.str()
+            << std::setw(COL_WIDTH_SIZE) << ask_sz.str()
+            << std::setw(COL_WIDTH_COUNT) << ask_ct.str();
+    }
+    out << "\n";
+}
+
+// one snapshot row, levels[0..level_count) are its Level records
+static void write_mbp_row(std::ostream &out, const TraceRecord &snap, const TraceRecord *levels, int level_count) {
+    out << std::left
+        << std::setw(COL_WIDTH_ORDER_ID) << snap.order_id
+        << std::setw(COL_WIDTH_ACTION) << snap.action
+        << std::setw(COL_WIDTH_SIDE) << snap.side
+        << std::setw(COL_WIDTH_DEPTH) << snap.depth
+        << std::setw(COL_WIDTH_PRICE) << std::fixed << std::setprecision(4) << price_to_double(snap.price)
+        << std::setw(COL_WIDTH_SIZE) << snap.size;
+
+    for (int i = 0; i < snap.size2; i++) {
+        std::string bid_px, bid_sz, bid_ct, ask_px, ask_sz, ask_ct;
+        if (i < level_count && (levels[i].flags & TRACE_BID)) {
+            bid_px = std::to_string(price_to_double(levels[i].price));
+            bid_sz = std::to_string(levels[i].size);
+            bid_ct = std::to_string(levels[i].count);
+        }
+        if (i < level_count && (levels[i].flags & TRACE_ASK)) {
+            ask_px = std::to_string(price_to_double(levels[i].price2));
+            ask_sz = std::to_string(levels[i].size2);
+            ask_ct = std::to_string(levels[i].count2);
+        }
+        out << std::setw(COL_WIDTH_PRICE) << bid_px
+            << std::setw(COL_WIDTH_SIZE) << bid_sz
+            << std::setw(COL_WIDTH_COUNT) << bid_ct
+            << std::setw(COL_WIDTH_PRICE) << ask_px
+            << std::setw(COL_WIDTH_SIZE) << ask_sz
+            << std::setw(COL_WIDTH_COUNT) << ask_ct;
+    }
+    out << "\n";
+}
+
+static void write_event(std::ostream &out, const TraceRecord &t) {
+    switch (static_cast<TraceType>(t.type)) {
+        case TraceType::TopOfBook:
+            if (t.flags & TRACE_BID) out << "Top Bid: " << price_to_double(t.price) << " x " << t.count << "\n";
+            if (t.flags & TRACE_ASK) out << "Top Ask: " << price_to_double(t.price2) << " x " << t.count2 << "\n";
+            break;
+        case TraceType::Add:
+            out << "[ADD] Order ID " << t.order_id << ": " << (t.side == 'B' ? "Bid" : "Ask") << " "
+                << t.size << " @ " << price_to_double(t.price) << "\n";
+            break;
+        case TraceType::Cancel:
+            // the old debug log printed the cancel's size after the @, kept so
+            // logs.txt compares line for line
+            out << "[CANCEL] Order ID " << t.order_id << ": " << (t.side == 'B' ? "Bid" : "Ask") << " "
+                << " @ " << t.size << "\n";
+            break;
+        case TraceType::Tfc:
+            out << "Processing T-F-C sequence: Trade on " << t.side << " side, canceling order " << t.order_id << "\n";
+            break;
+        case TraceType::EofPending:
+            out << "[DBG] EOF: Processing remaining buffered row. Action: " << t.action << ", Order ID: "
+                << t.order_id << "\n";
+            break;
+        case TraceType::MissedTop:
+            out << "[WARN] Missed book change for top-" << t.depth << " price: " << price_to_double(t.price)
+                << " at row: " << t.row << "\n";
+            break;
+        default:
+            break;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string input;
+    std::string logs_path = "logs.txt";
+    std::string mbp_logs_path = "mbp_logs.txt";
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--logs" && i + 1 < argc) {
+            logs_path = argv[++i];
+        } else if (arg == "--mbp-logs" && i + 1 < argc) {
+            mbp_logs_path = argv[++i];
+        } else if (input.empty() && arg[0] != '-') {
+            input = arg;
+        } else {
+            input.clear();
+            break;
+        }
+    }
+
+    if (input.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <trace.bin> [--logs <path>] [--mbp-logs <path>]" << std::endl;
+        return 1;
+    }
+
+    try {
+        MappedFile file(input);
+        TraceFileHeader header;
+        if (file.size() < sizeof(header)) {
+            throw std::runtime_error(input + ": not a trace file");
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 || header.version != TRACE_VERSION ||
+            header.record_size != sizeof(TraceRecord) || header.capacity == 0 ||
+            (header.capacity & (header.capacity - 1)) != 0) {
+            throw std::runtime_error(input + ": not a trace file (or another version)");
+        }
+
+        uint64_t count = header.head < header.capacity ? header.head : header.capacity;
+        if (file.size() < sizeof(header) + count * sizeof(TraceRecord)) {
+            throw std::runtime_error(input + ": truncated");
+        }
+        const TraceRecord *ring = reinterpret_cast<const TraceRecord *>(file.data() + sizeof(header));
+        uint64_t first = header.head - count; // oldest record still held
+        auto at = [&](uint64_t i) -> const TraceRecord & { return ring[(first + i) & (header.capacity - 1)]; };
+
+        std::ofstream logs(logs_path, std::ios::trunc);
+        std::ofstream mbp_logs(mbp_logs_path, std::ios::trunc);
+        if (!logs || !mbp_logs) {
+            throw std::runtime_error("cannot write " + (logs ? mbp_logs_path : logs_path));
+        }
+
+        uint64_t counts[TYPE_COUNT] = {};
+        bool header_written = false;
+        TraceRecord levels[MBP_MAX_DEPTH];
+
+        for (uint64_t i = 0; i < count; i++) {
+            const TraceRecord &t = at(i);
+            if (t.type > 0 && t.type < TYPE_COUNT) counts[t.type]++;
+
+            if (static_cast<TraceType>(t.type) != TraceType::Snapshot) {
+                write_event(logs, t); // Level records of a lost snapshot fall through here
+                continue;
+            }
+
+            if (!header_written) {
+                write_mbp_header(mbp_logs, t.size2);
+                header_written = true;
+            }
+            int level_count = 0;
+            while (i + 1 < count && static_cast<TraceType>(at(i + 1).type) == TraceType::Level &&
+                   level_count < MBP_MAX_DEPTH) {
+                levels[level_count++] = at(++i);
+                counts[static_cast<int>(TraceType::Level)]++;
+            }
+            write_mbp_row(mbp_logs, t, levels, level_count);
+        }
+
+        std::cout << input << ": thread " << header.thread_index << ", " << count << " records";
+        if (header.head > count) {
+            std::cout << " (ring wrapped, " << header.head - count << " oldest overwritten)";
+        }
+        std::cout << std::endl;
+        for (int type = 1; type < TYPE_COUNT; type++) {
+            std::cout << "  " << std::setw(12) << std::left << TYPE_NAMES[type] << counts[type] << std::endl;
+        }
+        std::cout << "Wrote " << logs_path << " and " << mbp_logs_path << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
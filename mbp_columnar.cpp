@@ -0,0 +1,162 @@
+#include "mbp_columnar.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "mbp_writer.h"
+
+MbpColumnarWriter::MbpColumnarWriter(const std::string &path, int64_t resume_at, int depth, uint32_t columns)
+    : depth(depth), extra_columns(columns) {
+    fd = open_mbp_output(path, resume_at);
+    if (resume_at > 0) {
+        written = static_cast<uint64_t>(resume_at);
+    }
+
+    add_column("ts_event", 'i', 8);
+    add_column("sequence", 'u', 4);
+    add_column("instrument_id", 'u', 4);
+    add_column("action", 'S', 1);
+    add_column("side", 'S', 1);
+    add_column("depth", 'i', 4);
+    add_column("price", 'i', 8);
+    add_column("size", 'i', 4);
+    add_column("order_id", 'i', 8);
+
+    for (int i = 0; i < depth; i++) {
+        std::string id = (i < 10 ? "0" : "") + std::to_string(i);
+        for (const char *side : { "bid", "ask" }) {
+            add_column(std::string(side) + "_px_" + id, 'i', 8);
+            add_column(std::string(side) + "_sz_" + id, 'i', 4);
+            add_column(std::string(side) + "_ct_" + id, 'i', 4);
+        }
+    }
+
+    if (extra_columns & MBP_COLUMNS_CONFLATION) {
+        add_column("conflated", 'u', 4);
+        add_column("bid_changed", 'u', 8);
+        add_column("ask_changed", 'u', 8);
+    }
+    if (extra_columns & MBP_COLUMNS_ANALYTICS) {
+        add_column("microprice", 'i', 8);
+        add_column("imbalance", 'f', 8);
+        add_column("wmid", 'i', 8);
+        for (const char *name : { "bid_depth_5", "ask_depth_5", "bid_depth_10", "ask_depth_10" }) {
+            add_column(name, 'i', 8);
+        }
+    }
+}
+
+MbpColumnarWriter::~MbpColumnarWriter() {
+    if (fd >= 0) {
+        flush();
+        ::close(fd);
+    }
+}
+
+void MbpColumnarWriter::add_column(const std::string &name, char type, uint8_t size) {
+    Column column;
+    std::memset(&column.field, 0, sizeof(column.field));
+    std::strncpy(column.field.name, name.c_str(), sizeof(column.field.name) - 1);
+    column.field.type = type;
+    column.field.size = size;
+    column.data.resize(BLOCK_ROWS * size);
+    columns.push_back(std::move(column));
+}
+
+void MbpColumnarWriter::write_bytes(const void *p, size_t n) {
+    const char *bytes = static_cast<const char *>(p);
+    while (n > 0) {
+        ssize_t w = ::write(fd, bytes, n);
+        if (w <= 0) {
+            throw std::runtime_error("columnar output write failed");
+        }
+        bytes += w;
+        n -= static_cast<size_t>(w);
+        written += static_cast<uint64_t>(w);
+    }
+}
+
+void MbpColumnarWriter::write_header() {
+    MbpColumnarHeader header = {};
+    std::memcpy(header.magic, MBP_COLUMNAR_MAGIC, sizeof(header.magic));
+    header.version = MBP_COLUMNAR_VERSION;
+    header.field_count = static_cast<uint32_t>(columns.size());
+    header.depth = static_cast<uint32_t>(depth);
+    header.price_scale_digits = PRICE_SCALE_DIGITS;
+
+    write_bytes(&header, sizeof(header));
+    for (const Column &column : columns) {
+        write_bytes(&column.field, sizeof(column.field));
+    }
+}
+
+template<typename T>
+void MbpColumnarWriter::put(size_t column, T value) {
+    std::memcpy(columns[column].data.data() + rows * sizeof(T), &value, sizeof(T));
+}
+
+template<int Depth>
+void MbpColumnarWriter::write_row(const MbpSnapshot<Depth> &snap) {
+    const MboRecord &rec = *snap.rec;
+    size_t c = 0;
+
+    put<int64_t>(c++, rec.ts_event);
+    put<uint32_t>(c++, rec.sequence);
+    put<uint32_t>(c++, rec.instrument_id);
+    put<char>(c++, snap.action);
+    put<char>(c++, snap.side);
+    put<int32_t>(c++, snap.depth);
+    put<int64_t>(c++, snap.price);
+    put<int32_t>(c++, snap.size);
+    put<int64_t>(c++, static_cast<int64_t>(snap.order_id));
+
+    for (int i = 0; i < Depth; i++) {
+        const MbpLevel empty = { 0, 0, 0 };
+        const MbpLevel &bid = i < snap.bid_count ? snap.bids[i] : empty;
+        const MbpLevel &ask = i < snap.ask_count ? snap.asks[i] : empty;
+
+        for (const MbpLevel *level : { &bid, &ask }) {
+            put<int64_t>(c++, level->px);
+            put<int32_t>(c++, level->sz);
+            put<int32_t>(c++, level->ct);
+        }
+    }
+
+    if (extra_columns & MBP_COLUMNS_CONFLATION) {
+        put<uint32_t>(c++, snap.conflated);
+        put<uint64_t>(c++, snap.bid_changed);
+        put<uint64_t>(c++, snap.ask_changed);
+    }
+    if (extra_columns & MBP_COLUMNS_ANALYTICS) {
+        const BookFeatures &f = snap.features;
+        put<int64_t>(c++, f.microprice);
+        put<double>(c++, f.imbalance);
+        put<int64_t>(c++, f.wmid);
+        for (int64_t depth : { f.bid_depth_5, f.ask_depth_5, f.bid_depth_10, f.ask_depth_10 }) {
+            put<int64_t>(c++, depth);
+        }
+    }
+
+    if (++rows == BLOCK_ROWS) {
+        flush();
+    }
+}
+
+void MbpColumnarWriter::flush() {
+    if (rows == 0) return;
+
+    MbpColumnarBlock block = { static_cast<uint32_t>(rows), 0 };
+    write_bytes(&block, sizeof(block));
+
+    for (const Column &column : columns) {
+        write_bytes(column.data.data(), rows * column.field.size);
+    }
+    rows = 0;
+}
+
+template void MbpColumnarWriter::write_row(const MbpSnapshot<1> &);
+template void MbpColumnarWriter::write_row(const MbpSnapshot<10> &);
+template void MbpColumnarWriter::write_row(const MbpSnapshot<50> &);
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mbp_snapshot.h"
+
+// Columnar binary MBP-N output (little-endian), for loading straight into
+// numpy. Layout:
+//
+//   MbpColumnarHeader
+//   MbpColumnarField x field_count      schema, in column order
+//   blocks until EOF, each:
+//     MbpColumnarBlock                  row count of the block
+//     one contiguous array per field    row_count x field size, schema order
+//
+// Columns: ts_event (i64 ns), sequence (u32), instrument_id (u32, tells the
+// books of a merged multi-instrument run apart), action, side (u8 chars),
+// depth (i32), price (i64 ticks), size (i32), order_id (i64), then for each
+// level 00..depth-1 bid_px, bid_sz, bid_ct, ask_px, ask_sz, ask_ct. Prices are
+// fixed-point ticks of 10^-price_scale_digits; an empty level has ct 0 and
+// px 0. With MBP_COLUMNS_CONFLATION, conflated (u32), bid_changed and
+// ask_changed (u64 level masks) follow; with MBP_COLUMNS_ANALYTICS,
+// microprice (i64 ticks), imbalance (f64), wmid (i64 ticks) and bid/ask
+// depth_5 / depth_10 (i64), the first three 0 on a one-sided book.
+
+constexpr char MBP_COLUMNAR_MAGIC[8] = { 'M', 'B', 'P', 'C', 'O', 'L', '0', '1' };
+constexpr uint32_t MBP_COLUMNAR_VERSION = 2; // 2: instrument_id column
+
+struct MbpColumnarHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t field_count;
+    uint32_t depth;
+    int32_t price_scale_digits;
+};
+static_assert(sizeof(MbpColumnarHeader) == 24, "MbpColumnarHeader layout");
+
+// type codes follow numpy kinds: 'i' signed, 'u' unsigned, 'f' float, 'S' bytes
+struct MbpColumnarField {
+    char name[22];
+    char type;
+    uint8_t size;
+};
+static_assert(sizeof(MbpColumnarField) == 24, "MbpColumnarField layout");
+
+struct MbpColumnarBlock {
+    uint32_t row_count;
+    uint32_t reserved;
+};
+static_assert(sizeof(MbpColumnarBlock) == 8, "MbpColumnarBlock layout");
+
+class MbpColumnarWriter {
+public:
+    // rows buffered per block before it is written out
+    static constexpr size_t BLOCK_ROWS = 1 << 13;
+
+    // resume_at >= 0 reopens an existing output cut back to that many bytes
+    // (checkpoint restore) instead of truncating it; skip write_header then.
+    // depth is the level count of the schema and of every row written,
+    // columns the MBP_COLUMNS_* set appended after the levels.
+    explicit MbpColumnarWriter(const std::string &path, int64_t resume_at = -1, int depth = MBP_DEPTH, uint32_t columns = 0);
+    ~MbpColumnarWriter();
+
+    MbpColumnarWriter(const MbpColumnarWriter &) = delete;
+    MbpColumnarWriter &operator=(const MbpColumnarWriter &) = delete;
+
+    void write_header();
+    template<int Depth>
+    void write_row(const MbpSnapshot<Depth> &snap);
+    void flush();
+
+    uint64_t bytes_written() const { return written; }
+
+private:
+    struct Column {
+        MbpColumnarField field;
+        std::vector<char> data;
+    };
+
+    int fd = -1;
+    int depth;
+    uint32_t extra_columns;
+    uint64_t written = 0;
+    size_t rows = 0;
+    std::vector<Column> columns;
+
+    void add_column(const std::string &name, char type, uint8_t size);
+    void write_bytes(const void *p, size_t n);
+
+    template<typename T>
+    void put(size_t column, T value);
+};
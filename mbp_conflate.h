@@ -0,0 +1,122 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "mbo_parser.h"
+#include "mbp_snapshot.h"
+
+// Snapshot conflation: consecutive rows whose ts_event falls in the same key
+// (the same ts_event, or the same fixed-size time bucket) are coalesced into
+// the last of them. The emitted row carries the book and event columns of
+// that last row plus the number of rows it stands for and, per side, a mask
+// of the levels that changed since the previous emitted row (bit i = level i,
+// set even if the level later went back to its old value).
+
+enum class ConflatePolicy { None, SameTs, Window };
+
+struct ConflateConfig {
+    ConflatePolicy policy = ConflatePolicy::None;
+    int64_t window_ns = 0; // bucket size for ConflatePolicy::Window
+
+    bool enabled() const { return policy != ConflatePolicy::None; }
+};
+
+// "ts" -> same ts_event; "<n>ns|us|ms|s" -> fixed window. False if malformed.
+inline bool parse_conflate(const std::string &text, ConflateConfig &config) {
+    if (text == "ts") {
+        config.policy = ConflatePolicy::SameTs;
+        return true;
+    }
+
+    size_t digits = text.find_first_not_of("0123456789");
+    if (digits == 0 || digits == std::string::npos) return false;
+
+    std::string unit = text.substr(digits);
+    int64_t scale = unit == "ns" ? 1 : unit == "us" ? 1000 : unit == "ms" ? 1000000 : unit == "s" ? 1000000000 : 0;
+    int64_t count = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + digits, count);
+    if (ec != std::errc() || scale == 0 || count <= 0 || count > INT64_MAX / scale) return false;
+
+    config.policy = ConflatePolicy::Window;
+    config.window_ns = count * scale;
+    return true;
+}
+
+// Writer adapter: holds the latest row of the current key and hands it to
+// output once a row with another key arrives, or on flush(). Rows are
+// renumbered so the output index stays dense.
+template<typename Writer, int Depth = MBP_DEPTH>
+class MbpConflator {
+public:
+    MbpConflator(Writer &output, const ConflateConfig &config) : output(output), config(config) {}
+
+    void write_row(const MbpSnapshot<Depth> &snap) {
+        int64_t key = key_of(snap.rec->ts_event);
+        if (held && key != held_key) emit();
+
+        const MbpSnapshot<Depth> &before = held ? pending : last;
+        uint64_t bid_changed = (held ? pending.bid_changed : 0) | changed_mask(before.bids, before.bid_count, snap.bids, snap.bid_count);
+        uint64_t ask_changed = (held ? pending.ask_changed : 0) | changed_mask(before.asks, before.ask_count, snap.asks, snap.ask_count);
+        uint32_t conflated = (held ? pending.conflated : 0) + 1;
+
+        rec = *snap.rec;
+        if (rec.symbol != symbol) symbol.assign(rec.symbol);
+        rec.symbol = symbol;
+        pending = snap;
+        pending.rec = &rec;
+        pending.conflated = conflated;
+        pending.bid_changed = bid_changed;
+        pending.ask_changed = ask_changed;
+        held = true;
+        held_key = key;
+        rows_in++;
+    }
+
+    // emits the held row; in live mode this means a key can span two rows
+    void flush() {
+        if (held) emit();
+        output.flush();
+    }
+
+    void print_summary(std::ostream &out) const {
+        out << "Conflation: " << rows_in << " rows -> " << rows_out << std::endl;
+    }
+
+private:
+    Writer &output;
+    ConflateConfig config;
+    MboRecord rec;               // copy of the record behind pending
+    std::string symbol;          // backs rec.symbol, the input may be gone by flush()
+    MbpSnapshot<Depth> pending;  // latest row of the open key
+    MbpSnapshot<Depth> last = {}; // levels of the previous emitted row
+    bool held = false;
+    int64_t held_key = 0;
+    int rows_out = 0;
+    uint64_t rows_in = 0;
+
+    int64_t key_of(int64_t ts_event) const {
+        if (config.policy != ConflatePolicy::Window) return ts_event;
+        return ts_event / config.window_ns - (ts_event % config.window_ns < 0 ? 1 : 0);
+    }
+
+    static uint64_t changed_mask(const MbpLevel *a, int a_count, const MbpLevel *b, int b_count) {
+        uint64_t mask = 0;
+        for (int i = 0; i < Depth; i++) {
+            bool a_live = i < a_count, b_live = i < b_count;
+            bool same = a_live == b_live &&
+                        (!a_live || (a[i].px == b[i].px && a[i].sz == b[i].sz && a[i].ct == b[i].ct));
+            if (!same) mask |= uint64_t(1) << i;
+        }
+        return mask;
+    }
+
+    void emit() {
+        pending.row_index = rows_out++;
+        output.write_row(pending);
+        last = pending;
+        held = false;
+    }
+};
@@ -0,0 +1,289 @@
+#include "mbp_delta.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "mbp_writer.h"
+
+// flush threshold; one row is well under 8 KiB (a depth-50 keyframe is
+// 64 + 255 + 100 x 24 + 88 bytes)
+static constexpr size_t WRITE_BUFFER_SIZE = 1 << 20;
+static constexpr size_t MAX_ROW_SIZE = 8192;
+
+MbpDeltaWriter::MbpDeltaWriter(const std::string &path, int64_t resume_at, int depth, uint32_t columns)
+    : depth(depth), columns(columns), buffer(WRITE_BUFFER_SIZE) {
+    fd = open_mbp_output(path, resume_at);
+    if (resume_at > 0) {
+        written = static_cast<uint64_t>(resume_at);
+    }
+}
+
+MbpDeltaWriter::~MbpDeltaWriter() {
+    if (fd >= 0) {
+        flush();
+        ::close(fd);
+    }
+}
+
+void MbpDeltaWriter::flush() {
+    const char *p = buffer.data();
+    size_t left = used;
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n <= 0) {
+            throw std::runtime_error("delta output write failed");
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+        written += static_cast<uint64_t>(n);
+    }
+    used = 0;
+}
+
+void MbpDeltaWriter::reserve(size_t bytes) {
+    if (used + bytes > buffer.size()) {
+        flush();
+    }
+}
+
+void MbpDeltaWriter::write_header() {
+    MbpDeltaHeader header = {};
+    std::memcpy(header.magic, MBP_DELTA_MAGIC, sizeof(header.magic));
+    header.version = MBP_DELTA_VERSION;
+    header.depth = static_cast<uint32_t>(depth);
+    header.price_scale_digits = PRICE_SCALE_DIGITS;
+    header.columns = columns;
+    header.keyframe_interval = MBP_DELTA_KEYFRAME_ROWS;
+
+    reserve(sizeof(header));
+    std::memcpy(buffer.data() + used, &header, sizeof(header));
+    used += sizeof(header);
+}
+
+MbpDeltaWriter::InstrumentState &MbpDeltaWriter::state_of(uint32_t instrument_id) {
+    // rows mostly come in runs of one instrument
+    if (last_state && last_instrument == instrument_id) return *last_state;
+    last_instrument = instrument_id;
+    last_state = &instruments[instrument_id];
+    return *last_state;
+}
+
+// Appends the updates turning prev into next to out and applies them to
+// prev, returns how many. Greedy over the first differing level: a price
+// that reappears one level lower was pushed down by an insert, one that
+// reappears one level higher was pulled up by a delete, anything else is
+// overwritten in place.
+int MbpDeltaWriter::diff_side(char side, MbpLevel *prev, int &prev_count, const MbpLevel *next, int next_count, char *out) {
+    int updates = 0;
+    int i = 0;
+    for (;;) {
+        while (i < prev_count && i < next_count && prev[i].px == next[i].px && prev[i].sz == next[i].sz &&
+               prev[i].ct == next[i].ct) {
+            i++;
+        }
+        if (i >= next_count && i >= prev_count) break;
+
+        MbpDeltaUpdate u = {};
+        u.side = side;
+        u.level = static_cast<uint8_t>(i);
+        if (i >= next_count) {
+            u.op = MbpDeltaOp::Delete;
+        } else if (i < prev_count && prev[i].px != next[i].px && i + 1 < next_count && next[i + 1].px == prev[i].px) {
+            u.op = MbpDeltaOp::Insert;
+        } else if (i < prev_count && prev[i].px != next[i].px && i + 1 < prev_count && prev[i + 1].px == next[i].px) {
+            u.op = MbpDeltaOp::Delete;
+        } else {
+            u.op = MbpDeltaOp::Set;
+        }
+        if (u.op != MbpDeltaOp::Delete) {
+            u.px = next[i].px;
+            u.sz = next[i].sz;
+            u.ct = next[i].ct;
+        }
+
+        mbp_delta_apply(prev, prev_count, depth, u);
+        std::memcpy(out + updates * sizeof(u), &u, sizeof(u));
+        updates++;
+    }
+    return updates;
+}
+
+template<int Depth>
+void MbpDeltaWriter::write_row(const MbpSnapshot<Depth> &snap) {
+    const MboRecord &rec = *snap.rec;
+    if (rec.symbol.size() > 255) {
+        throw std::runtime_error("delta output: symbol longer than 255 bytes");
+    }
+    reserve(MAX_ROW_SIZE);
+    char *out = buffer.data() + used;
+
+    InstrumentState &state = state_of(rec.instrument_id);
+    bool keyframe = state.rows_since_keyframe == 0 || state.rows_since_keyframe >= MBP_DELTA_KEYFRAME_ROWS ||
+                    rec.symbol != state.symbol;
+    if (keyframe) {
+        state.count[0] = state.count[1] = 0;
+        state.rows_since_keyframe = 0;
+        state.symbol.assign(rec.symbol);
+    }
+    state.rows_since_keyframe++;
+
+    MbpDeltaRow row = {};
+    row.ts_event = rec.ts_event;
+    row.price = snap.price;
+    row.order_id = snap.order_id;
+    row.row_index = snap.row_index;
+    row.depth = snap.depth;
+    row.size = snap.size;
+    row.ts_in_delta = rec.ts_in_delta;
+    row.sequence = rec.sequence;
+    row.instrument_id = rec.instrument_id;
+    row.publisher_id = rec.publisher_id;
+    row.action = snap.action;
+    row.side = snap.side;
+    row.flags = rec.flags;
+    row.kind = keyframe ? MBP_DELTA_KEYFRAME : 0;
+    row.symbol_length = keyframe ? static_cast<uint8_t>(rec.symbol.size()) : 0;
+
+    char *p = out + sizeof(row);
+    std::memcpy(p, rec.symbol.data(), row.symbol_length);
+    p += row.symbol_length;
+
+    int updates = diff_side('B', state.levels[0], state.count[0], snap.bids, snap.bid_count, p);
+    p += updates * sizeof(MbpDeltaUpdate);
+    int ask_updates = diff_side('A', state.levels[1], state.count[1], snap.asks, snap.ask_count, p);
+    p += ask_updates * sizeof(MbpDeltaUpdate);
+    row.update_count = static_cast<uint16_t>(updates + ask_updates);
+    std::memcpy(out, &row, sizeof(row));
+
+    if (columns & MBP_COLUMNS_CONFLATION) {
+        MbpDeltaConflation c = { snap.conflated, 0, snap.bid_changed, snap.ask_changed };
+        std::memcpy(p, &c, sizeof(c));
+        p += sizeof(c);
+    }
+    if (columns & MBP_COLUMNS_ANALYTICS) {
+        const BookFeatures &f = snap.features;
+        MbpDeltaAnalytics a = {};
+        a.microprice = f.microprice;
+        a.imbalance = f.imbalance;
+        a.wmid = f.wmid;
+        a.bid_depth_5 = f.bid_depth_5;
+        a.ask_depth_5 = f.ask_depth_5;
+        a.bid_depth_10 = f.bid_depth_10;
+        a.ask_depth_10 = f.ask_depth_10;
+        a.two_sided = f.two_sided;
+        std::memcpy(p, &a, sizeof(a));
+        p += sizeof(a);
+    }
+
+    used = p - buffer.data();
+}
+
+template void MbpDeltaWriter::write_row(const MbpSnapshot<1> &);
+template void MbpDeltaWriter::write_row(const MbpSnapshot<10> &);
+template void MbpDeltaWriter::write_row(const MbpSnapshot<50> &);
+
+// READER
+MbpDeltaReader::MbpDeltaReader(const std::string &path) : file(path) {
+    std::memcpy(&header, take(sizeof(header)), sizeof(header));
+    if (std::memcmp(header.magic, MBP_DELTA_MAGIC, sizeof(header.magic)) != 0 || header.version != MBP_DELTA_VERSION) {
+        throw std::runtime_error(path + ": not an MBP delta file (or another version)");
+    }
+    if (header.price_scale_digits != PRICE_SCALE_DIGITS) {
+        throw std::runtime_error(path + ": written with another price scale");
+    }
+}
+
+const char *MbpDeltaReader::take(size_t bytes) {
+    if (file.size() - pos < bytes) {
+        throw std::runtime_error("MBP delta file truncated at byte " + std::to_string(pos));
+    }
+    const char *p = file.data() + pos;
+    pos += bytes;
+    return p;
+}
+
+template<int Depth>
+bool MbpDeltaReader::next(MbpSnapshot<Depth> &snap) {
+    if (static_cast<int>(header.depth) != Depth) {
+        throw std::runtime_error("MBP delta file has depth " + std::to_string(header.depth));
+    }
+    if (pos == file.size()) return false;
+
+    MbpDeltaRow row;
+    std::memcpy(&row, take(sizeof(row)), sizeof(row));
+
+    InstrumentBook &book = books[row.instrument_id];
+    if (row.kind & MBP_DELTA_KEYFRAME) {
+        book.keyed = true;
+        book.count[0] = book.count[1] = 0;
+        book.symbol.assign(take(row.symbol_length), row.symbol_length);
+    } else if (!book.keyed) {
+        throw std::runtime_error("MBP delta row " + std::to_string(row.row_index) + " of instrument " +
+                                 std::to_string(row.instrument_id) + " precedes its keyframe");
+    }
+
+    const char *updates = take(row.update_count * sizeof(MbpDeltaUpdate));
+    for (int i = 0; i < row.update_count; i++) {
+        MbpDeltaUpdate u;
+        std::memcpy(&u, updates + i * sizeof(u), sizeof(u));
+        int s = u.side == 'B' ? 0 : 1;
+        if ((u.side != 'B' && u.side != 'A') || u.level >= Depth || u.level > book.count[s] ||
+            (u.op == MbpDeltaOp::Delete && u.level == book.count[s])) {
+            throw std::runtime_error("MBP delta row " + std::to_string(row.row_index) + ": bad level update");
+        }
+        mbp_delta_apply(book.levels[s], book.count[s], Depth, u);
+    }
+
+    rec.ts_recv = row.ts_event;
+    rec.ts_event = row.ts_event;
+    rec.rtype = static_cast<uint8_t>(Depth);
+    rec.publisher_id = row.publisher_id;
+    rec.instrument_id = row.instrument_id;
+    rec.action = row.action;
+    rec.side = row.side;
+    rec.price = row.price;
+    rec.size = row.size;
+    rec.order_id = row.order_id;
+    rec.flags = row.flags;
+    rec.ts_in_delta = row.ts_in_delta;
+    rec.sequence = row.sequence;
+    rec.symbol = book.symbol;
+
+    snap.rec = &rec;
+    snap.row_index = row.row_index;
+    snap.action = row.action;
+    snap.side = row.side;
+    snap.depth = row.depth;
+    snap.price = row.price;
+    snap.size = row.size;
+    snap.order_id = row.order_id;
+    snap.bid_count = book.count[0];
+    snap.ask_count = book.count[1];
+    std::memcpy(snap.bids, book.levels[0], book.count[0] * sizeof(MbpLevel));
+    std::memcpy(snap.asks, book.levels[1], book.count[1] * sizeof(MbpLevel));
+
+    if (header.columns & MBP_COLUMNS_CONFLATION) {
+        MbpDeltaConflation c;
+        std::memcpy(&c, take(sizeof(c)), sizeof(c));
+        snap.conflated = c.conflated;
+        snap.bid_changed = c.bid_changed;
+        snap.ask_changed = c.ask_changed;
+    }
+    if (header.columns & MBP_COLUMNS_ANALYTICS) {
+        MbpDeltaAnalytics a;
+        std::memcpy(&a, take(sizeof(a)), sizeof(a));
+        snap.features = { a.two_sided != 0, a.microprice, a.imbalance, a.wmid,
+                          a.bid_depth_5, a.ask_depth_5, a.bid_depth_10, a.ask_depth_10 };
+    }
+
+    row_count++;
+    update_count += row.update_count;
+    keyframe_count += (row.kind & MBP_DELTA_KEYFRAME) != 0;
+    return true;
+}
+
+template bool MbpDeltaReader::next(MbpSnapshot<1> &);
+template bool MbpDeltaReader::next(MbpSnapshot<10> &);
+template bool MbpDeltaReader::next(MbpSnapshot<50> &);
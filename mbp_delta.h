@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mapped_file.h"
+#include "mbp_snapshot.h"
+
+// Incremental MBP-N output (little-endian): instead of every level of every
+// row, each row carries its event fields and the level updates that turn the
+// previous row of the same instrument into this one. An add or cancel that
+// only resizes a level is one Set; a new price level is one Insert (levels
+// below shift down, the last one falls off at depth); a level that empties
+// is one Delete (levels below shift up), plus a Set if a level enters from
+// beyond the depth. Layout:
+//
+//   MbpDeltaHeader
+//   rows until EOF, each:
+//     MbpDeltaRow
+//     symbol_length bytes of symbol  keyframes only
+//     MbpDeltaUpdate x update_count
+//     MbpDeltaConflation             with MBP_COLUMNS_CONFLATION
+//     MbpDeltaAnalytics              with MBP_COLUMNS_ANALYTICS
+//
+// A keyframe starts the instrument's book over from empty and sets every
+// live level, so a reader can join at any keyframe. The first row of each
+// instrument is one, then every keyframe_interval-th row of it, and the first
+// row of each instrument after a checkpoint restore. MbpDeltaReader rebuilds
+// the exact MbpSnapshot rows (mbp_rebuild writes them out as csv/columnar).
+
+constexpr char MBP_DELTA_MAGIC[8] = { 'M', 'B', 'P', 'D', 'L', 'T', '0', '1' };
+constexpr uint32_t MBP_DELTA_VERSION = 1;
+constexpr uint32_t MBP_DELTA_KEYFRAME_ROWS = 1024; // rows of one instrument between keyframes
+
+struct MbpDeltaHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t depth;
+    int32_t price_scale_digits;
+    uint32_t columns;           // MBP_COLUMNS_* blocks after each row's updates
+    uint32_t keyframe_interval;
+    uint32_t reserved;
+};
+static_assert(sizeof(MbpDeltaHeader) == 32, "MbpDeltaHeader layout");
+
+// bits of MbpDeltaRow::kind
+constexpr uint8_t MBP_DELTA_KEYFRAME = 1;
+
+// event columns of one row, as in the csv output
+struct MbpDeltaRow {
+    int64_t ts_event;
+    int64_t price;
+    uint64_t order_id;
+    int32_t row_index;
+    int32_t depth;
+    int32_t size;
+    int32_t ts_in_delta;
+    uint32_t sequence;
+    uint32_t instrument_id;
+    uint16_t publisher_id;
+    uint16_t update_count;
+    char action;
+    char side;
+    uint8_t flags;           // of the MBO record
+    uint8_t kind;            // MBP_DELTA_KEYFRAME
+    uint8_t symbol_length;   // keyframes only
+    uint8_t reserved[7];
+};
+static_assert(sizeof(MbpDeltaRow) == 64, "MbpDeltaRow layout");
+
+enum class MbpDeltaOp : uint8_t {
+    Set = 'S',     // level = px/sz/ct; level == count appends
+    Insert = 'I',  // levels level.. shift down one (the last drops at depth), level = px/sz/ct
+    Delete = 'D',  // level removed, levels below shift up one
+};
+
+struct MbpDeltaUpdate {
+    char side;     // 'B' or 'A'
+    MbpDeltaOp op;
+    uint8_t level;
+    uint8_t reserved;
+    int32_t sz;
+    int64_t px;
+    int32_t ct;
+    uint32_t reserved2;
+};
+static_assert(sizeof(MbpDeltaUpdate) == 24, "MbpDeltaUpdate layout");
+
+struct MbpDeltaConflation {
+    uint32_t conflated;
+    uint32_t reserved;
+    uint64_t bid_changed;
+    uint64_t ask_changed;
+};
+static_assert(sizeof(MbpDeltaConflation) == 24, "MbpDeltaConflation layout");
+
+struct MbpDeltaAnalytics {
+    int64_t microprice;
+    double imbalance;
+    int64_t wmid;
+    int64_t bid_depth_5;
+    int64_t ask_depth_5;
+    int64_t bid_depth_10;
+    int64_t ask_depth_10;
+    uint8_t two_sided;
+    uint8_t reserved[7];
+};
+static_assert(sizeof(MbpDeltaAnalytics) == 64, "MbpDeltaAnalytics layout");
+
+// Applies one update to a side's levels (count live, at most depth); the
+// writer diffs through this too, so both ends agree on every shift.
+inline void mbp_delta_apply(MbpLevel *levels, int &count, int depth, const MbpDeltaUpdate &u) {
+    int level = u.level;
+    switch (u.op) {
+        case MbpDeltaOp::Set:
+            levels[level] = { u.px, u.sz, u.ct };
+            if (level == count) count++;
+            break;
+        case MbpDeltaOp::Insert:
+            if (count < depth) count++;
+            for (int i = count - 1; i > level; i--) levels[i] = levels[i - 1];
+            levels[level] = { u.px, u.sz, u.ct };
+            break;
+        case MbpDeltaOp::Delete:
+            for (int i = level; i + 1 < count; i++) levels[i] = levels[i + 1];
+            count--;
+            break;
+    }
+}
+
+class MbpDeltaWriter {
+public:
+    // resume_at >= 0 reopens an existing output cut back to that many bytes
+    // (checkpoint restore) instead of truncating it; skip write_header then.
+    // depth is the level count of every row written, columns the
+    // MBP_COLUMNS_* blocks carried after each row's updates.
+    explicit MbpDeltaWriter(const std::string &path, int64_t resume_at = -1, int depth = MBP_DEPTH, uint32_t columns = 0);
+    ~MbpDeltaWriter();
+
+    MbpDeltaWriter(const MbpDeltaWriter &) = delete;
+    MbpDeltaWriter &operator=(const MbpDeltaWriter &) = delete;
+
+    void write_header();
+    template<int Depth>
+    void write_row(const MbpSnapshot<Depth> &snap);
+    void flush();
+
+    uint64_t bytes_written() const { return written; }
+
+private:
+    // levels of the instrument's previous row, as the reader holds them
+    struct InstrumentState {
+        MbpLevel levels[2][MBP_MAX_DEPTH];
+        int count[2] = { 0, 0 };
+        uint32_t rows_since_keyframe = 0;
+        std::string symbol;
+    };
+
+    int fd = -1;
+    int depth;
+    uint32_t columns;
+    std::vector<char> buffer;
+    size_t used = 0;
+    uint64_t written = 0;
+    std::unordered_map<uint32_t, InstrumentState> instruments;
+    uint32_t last_instrument = 0;
+    InstrumentState *last_state = nullptr;
+
+    InstrumentState &state_of(uint32_t instrument_id);
+    int diff_side(char side, MbpLevel *prev, int &prev_count, const MbpLevel *next, int next_count, char *out);
+    void reserve(size_t bytes);
+};
+
+// Sequential reader of a delta file, rebuilding one MbpSnapshot per row.
+// Throws std::runtime_error on a malformed file or a row of an instrument
+// whose keyframe it has not seen.
+class MbpDeltaReader {
+public:
+    explicit MbpDeltaReader(const std::string &path);
+
+    int depth() const { return static_cast<int>(header.depth); }
+    uint32_t columns() const { return header.columns; }
+
+    // false at end of file; snap.rec points into the reader until the next call
+    template<int Depth>
+    bool next(MbpSnapshot<Depth> &snap);
+
+    uint64_t rows() const { return row_count; }
+    uint64_t updates() const { return update_count; }
+    uint64_t keyframes() const { return keyframe_count; }
+
+private:
+    struct InstrumentBook {
+        bool keyed = false; // a keyframe was read
+        MbpLevel levels[2][MBP_MAX_DEPTH];
+        int count[2] = { 0, 0 };
+        std::string symbol;
+    };
+
+    MappedFile file;
+    MbpDeltaHeader header;
+    size_t pos = 0;
+    MboRecord rec = {};
+    std::unordered_map<uint32_t, InstrumentBook> books;
+    uint64_t row_count = 0;
+    uint64_t update_count = 0;
+    uint64_t keyframe_count = 0;
+
+    const char *take(size_t bytes);
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+#include "book_side.h"
+#include "mbo_parser.h"
+#include "mbp_snapshot.h"
+#include "order_book.h"
+
+// In-process use of the reconstruction engine (libmbp.a, `make lib`): feed
+// MboRecords through on_mbo(), receive every MBP row in a sink. A sink is any
+// type with write_row(const MbpSnapshot<Depth> &); it is a template argument
+// of the book, so each row is a direct (inlinable) call with the snapshot
+// passed by reference. MbpCsvWriter, MbpColumnarWriter and MbpDeltaWriter are
+// sinks that write files, MbpCallbackSink hands rows to a callable.
+
+// Sink around a callable taking const MbpSnapshot<Depth> &. The snapshot and
+// its bid_levels() / ask_levels() views are only valid during the call.
+template<typename Fn>
+class MbpCallbackSink {
+public:
+    explicit MbpCallbackSink(Fn fn) : fn(std::move(fn)) {}
+
+    template<int Depth>
+    void write_row(const MbpSnapshot<Depth> &snap) { fn(snap); }
+
+    void flush() {}
+    uint64_t bytes_written() const { return 0; }
+
+private:
+    Fn fn;
+};
+
+// One instrument's book owning its sink. Records must be fed in input order;
+// finish() releases rows still held for T-F-C matching (end of input, or
+// before reading book state at a boundary). The symbol of a record must stay
+// valid until the next record has been fed.
+template<typename Sink, int Depth = MBP_DEPTH, template<bool> class BookSide = MapBookSide>
+class MbpEngine {
+public:
+    explicit MbpEngine(Sink sink, const BookConfig &config = BookConfig())
+        : output(std::move(sink)), book(output, config) {}
+
+    void on_mbo(const MboRecord &rec) { book.on_mbo(rec); }
+
+    void finish() { book.finish(); }
+
+    // whole input (MboParser, MboBinaryReader, MboCompressedReader), then finish()
+    template<typename Reader>
+    void load(Reader &reader) { book.load(reader); }
+
+    Sink &sink() { return output; }
+    OrderBook<BookSide, Sink, Depth> &order_book() { return book; }
+
+private:
+    Sink output;
+    OrderBook<BookSide, Sink, Depth> book;
+};
+
+// auto engine = make_mbp_engine([&](const MbpSnapshot<> &snap) { ... });
+template<int Depth = MBP_DEPTH, template<bool> class BookSide = MapBookSide, typename Fn>
+MbpEngine<MbpCallbackSink<Fn>, Depth, BookSide> make_mbp_engine(Fn fn, const BookConfig &config = BookConfig()) {
+    return MbpEngine<MbpCallbackSink<Fn>, Depth, BookSide>(MbpCallbackSink<Fn>(std::move(fn)), config);
+}
@@ -0,0 +1,73 @@
+// Rebuilds the full MBP-N rows of a delta file (mbp_delta.h), written by
+// the same writers as the engine's own output, so the result is
+// byte-identical to a run with --output-format csv / columnar.
+//
+//   ./mbp_rebuild output.mbpd [--output-format csv|columnar] [--output <path>]
+
+#include <iostream>
+#include <string>
+
+#include "mbp_columnar.h"
+#include "mbp_delta.h"
+#include "mbp_writer.h"
+
+template<typename Writer, int Depth>
+static uint64_t rebuild(MbpDeltaReader &reader, const std::string &output_path) {
+    Writer writer(output_path, -1, Depth, reader.columns());
+    writer.write_header();
+
+    MbpSnapshot<Depth> snap;
+    while (reader.next(snap)) {
+        writer.write_row(snap);
+    }
+    writer.flush();
+    return writer.bytes_written();
+}
+
+int main(int argc, char *argv[]) {
+    std::string input;
+    std::string output_format = "csv";
+    std::string output_path;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--output-format" && i + 1 < argc) {
+            output_format = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (input.empty() && arg[0] != '-') {
+            input = arg;
+        } else {
+            input.clear();
+            break;
+        }
+    }
+
+    if (input.empty() || (output_format != "csv" && output_format != "columnar")) {
+        std::cerr << "Usage: " << argv[0] << " <output.mbpd> [--output-format csv|columnar] [--output <path>]"
+                  << std::endl;
+        return 1;
+    }
+    if (output_path.empty()) {
+        output_path = output_format == "columnar" ? "rebuilt.mbpc" : "rebuilt.csv";
+    }
+
+    try {
+        MbpDeltaReader reader(input);
+        uint64_t bytes = with_mbp_depth(reader.depth(), [&](auto depth) {
+            if (output_format == "columnar") {
+                return rebuild<MbpColumnarWriter, depth.value>(reader, output_path);
+            }
+            return rebuild<MbpCsvWriter, depth.value>(reader, output_path);
+        });
+
+        std::cout << "Rebuilt " << reader.rows() << " rows (" << reader.keyframes() << " keyframes, "
+                  << reader.updates() << " level updates): " << bytes << " bytes (" << output_path << ")"
+                  << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
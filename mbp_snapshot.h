@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "book_analytics.h"
+#include "book_types.h"
+#include "mbo_parser.h"
+
+// levels per side: OrderBook and the writers take the depth as a template
+// argument (MBP-1, MBP-10 or MBP-50, main picks one at run time); MBP_DEPTH
+// is the default
+constexpr int MBP_DEPTH = 10;
+constexpr int MBP_MAX_DEPTH = 50;
+
+// Calls fn(std::integral_constant<int, depth>()) for a supported depth (1,
+// 10, 50; the writers instantiate write_row for exactly these), returns its
+// result. Unsupported depths throw.
+template<typename Fn>
+auto with_mbp_depth(int depth, Fn fn) {
+    switch (depth) {
+        case 1: return fn(std::integral_constant<int, 1>());
+        case 10: return fn(std::integral_constant<int, 10>());
+        case 50: return fn(std::integral_constant<int, 50>());
+        default: throw std::invalid_argument("unsupported MBP depth " + std::to_string(depth));
+    }
+}
+
+// Non-owning view of one side's live levels, best first (a std::span
+// stand-in, the tree is C++17).
+struct MbpLevels {
+    const MbpLevel *data;
+    int count;
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    const MbpLevel &operator[](int i) const { return data[i]; }
+    const MbpLevel *begin() const { return data; }
+    const MbpLevel *end() const { return data + count; }
+};
+
+// One MBP-N row as handed to the writer: the MBO record that produced it,
+// the event columns and the visible levels of both sides (best first).
+template<int Depth = MBP_DEPTH>
+struct MbpSnapshot {
+    static_assert(Depth > 0 && Depth <= MBP_MAX_DEPTH, "MBP depth out of range");
+    static constexpr int DEPTH = Depth;
+
+    const MboRecord *rec;
+    int row_index;
+    char action;
+    char side;
+    int depth;
+    Price price;
+    int size;
+    uint64_t order_id;
+    int bid_count; // live levels in bids[]
+    int ask_count; // live levels in asks[]
+    MbpLevel bids[Depth];
+    MbpLevel asks[Depth];
+
+    MbpLevels bid_levels() const { return { bids, bid_count }; }
+    MbpLevels ask_levels() const { return { asks, ask_count }; }
+
+    // conflated output only (mbp_conflate.h): rows folded into this one and
+    // the levels (bit i = level i) that changed since the previous row
+    uint32_t conflated = 1;
+    uint64_t bid_changed = 0;
+    uint64_t ask_changed = 0;
+
+    // analytics output only (book_analytics.h)
+    BookFeatures features = {};
+};
+
+// optional trailing output columns, or-ed into the writers' columns argument
+constexpr uint32_t MBP_COLUMNS_CONFLATION = 1; // conflated, bid_changed, ask_changed
+constexpr uint32_t MBP_COLUMNS_ANALYTICS = 2;  // microprice, imbalance, wmid, bid/ask depth_5 / depth_10
@@ -0,0 +1,229 @@
+#include "mbp_writer.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// flush threshold; far above the largest row (MBP-50 with every column)
+static constexpr size_t WRITE_BUFFER_SIZE = 1 << 20;
+// upper bounds of the encoded row parts, for the per-row reserve: index,
+// timestamps, event columns and order_id; one ",px,sz,ct" per side and
+// level; the conflation and the analytics columns
+static constexpr size_t ROW_FIXED_SIZE = 512;
+static constexpr size_t ROW_LEVEL_SIZE = 64;
+static constexpr size_t ROW_CONFLATION_SIZE = 128;
+static constexpr size_t ROW_ANALYTICS_SIZE = 256;
+
+int open_mbp_output(const std::string &path, int64_t resume_at) {
+    int flags = O_WRONLY | O_CREAT | (resume_at < 0 ? O_TRUNC : 0);
+    int fd = ::open(path.c_str(), flags, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    if (resume_at < 0) return fd;
+
+    off_t size = ::lseek(fd, 0, SEEK_END);
+    if (size < resume_at || ::ftruncate(fd, resume_at) != 0 || ::lseek(fd, resume_at, SEEK_SET) != resume_at) {
+        ::close(fd);
+        throw std::runtime_error("cannot resume " + path + " at byte " + std::to_string(resume_at));
+    }
+    return fd;
+}
+
+MbpCsvWriter::MbpCsvWriter(const std::string &path, int64_t resume_at, int depth, uint32_t columns)
+    : depth(depth), columns(columns), buffer(WRITE_BUFFER_SIZE) {
+    max_row_size = ROW_FIXED_SIZE + 2 * static_cast<size_t>(depth) * ROW_LEVEL_SIZE +
+                   (columns & MBP_COLUMNS_CONFLATION ? ROW_CONFLATION_SIZE : 0) +
+                   (columns & MBP_COLUMNS_ANALYTICS ? ROW_ANALYTICS_SIZE : 0);
+    fd = open_mbp_output(path, resume_at);
+    if (resume_at > 0) {
+        written = static_cast<uint64_t>(resume_at);
+    }
+}
+
+MbpCsvWriter::~MbpCsvWriter() {
+    if (fd >= 0) {
+        // the run paths flush (and report errors) before this; don't throw
+        // out of a destructor during unwinding
+        try {
+            flush();
+        } catch (const std::exception &) {
+        }
+        ::close(fd);
+    }
+}
+
+void MbpCsvWriter::flush() {
+    const char *p = buffer.data();
+    size_t left = used;
+    used = 0;
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            throw std::runtime_error(std::string("csv output write failed: ") +
+                                     (n < 0 ? std::strerror(errno) : "no progress"));
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+        written += static_cast<uint64_t>(n);
+    }
+}
+
+void MbpCsvWriter::reserve(size_t bytes) {
+    if (used + bytes > buffer.size()) {
+        flush();
+    }
+}
+
+// ENCODE HELPERS
+static char *put(char *out, std::string_view s) {
+    std::memcpy(out, s.data(), s.size());
+    return out + s.size();
+}
+
+static char *put_int(char *out, long long value) {
+    return std::to_chars(out, out + 24, value).ptr;
+}
+
+static char *put_uint(char *out, unsigned long long value) {
+    return std::to_chars(out, out + 24, value).ptr;
+}
+
+void MbpCsvWriter::write_header() {
+    reserve(max_row_size); // level names are shorter than level values
+    char *out = buffer.data() + used;
+
+    out = put(out, " ,ts_recv,ts_event,rtype,publisher_id,instrument_id,action,side,depth,price,size,flags,ts_in_delta,sequence");
+
+    for (int i = 0; i < depth; i++) {
+        char level[2] = { static_cast<char>('0' + i / 10), static_cast<char>('0' + i % 10) };
+        std::string_view id(level, 2);
+
+        for (const char *name : { ",bid_px_", ",bid_sz_", ",bid_ct_", ",ask_px_", ",ask_sz_", ",ask_ct_" }) {
+            out = put(out, name);
+            out = put(out, id);
+        }
+    }
+
+    out = put(out, ",symbol,order_id");
+    if (columns & MBP_COLUMNS_CONFLATION) {
+        out = put(out, ",conflated,bid_changed,ask_changed");
+    }
+    if (columns & MBP_COLUMNS_ANALYTICS) {
+        out = put(out, ",microprice,imbalance,wmid,bid_depth_5,ask_depth_5,bid_depth_10,ask_depth_10");
+    }
+    *out++ = '\n';
+    used = out - buffer.data();
+}
+
+char *MbpCsvWriter::encode_level(char *out, CachedLevel &cached, const MbpLevel *level) {
+    if (!level) {
+        cached.present = false;
+        return put(out, ",,0,0");
+    }
+
+    bool unchanged = cached.present && cached.level.px == level->px &&
+                     cached.level.sz == level->sz && cached.level.ct == level->ct;
+    if (!unchanged) {
+        char *p = cached.text;
+        *p++ = ',';
+        p = format_price(p, level->px);
+        *p++ = ',';
+        p = put_int(p, level->sz);
+        *p++ = ',';
+        p = put_int(p, level->ct);
+
+        cached.present = true;
+        cached.level = *level;
+        cached.len = static_cast<int>(p - cached.text);
+    }
+
+    std::memcpy(out, cached.text, cached.len);
+    return out + cached.len;
+}
+
+template<int Depth>
+void MbpCsvWriter::write_row(const MbpSnapshot<Depth> &snap) {
+    const MboRecord &rec = *snap.rec;
+    reserve(max_row_size + rec.symbol.size());
+    char *out = buffer.data() + used;
+
+    out = put_int(out, snap.row_index);
+    *out++ = ',';
+    // the ts_recv and ts_event columns both carry ts_event: render once, copy
+    char *ts_text = out;
+    out = timestamps.format(out, rec.ts_event);
+    *out++ = ',';
+    std::memcpy(out, ts_text, TIMESTAMP_TEXT_SIZE);
+    out += TIMESTAMP_TEXT_SIZE;
+    *out++ = ',';
+    out = put_int(out, Depth); // rtype: MBP-1 is 1, MBP-10 is 10
+    *out++ = ',';
+    out = put_int(out, rec.publisher_id);
+    *out++ = ',';
+    out = put_int(out, rec.instrument_id);
+    *out++ = ',';
+    *out++ = snap.action;
+    *out++ = ',';
+    *out++ = snap.side;
+    *out++ = ',';
+    out = put_int(out, snap.depth);
+    *out++ = ',';
+    out = format_price(out, snap.price);
+    *out++ = ',';
+    out = put_int(out, snap.size);
+    *out++ = ',';
+    out = put_int(out, rec.flags);
+    *out++ = ',';
+    out = put_int(out, rec.ts_in_delta);
+    *out++ = ',';
+    out = put_int(out, rec.sequence);
+
+    for (int i = 0; i < Depth; i++) {
+        out = encode_level(out, cache[0][i], i < snap.bid_count ? &snap.bids[i] : nullptr);
+        out = encode_level(out, cache[1][i], i < snap.ask_count ? &snap.asks[i] : nullptr);
+    }
+
+    *out++ = ',';
+    out = put(out, rec.symbol);
+    *out++ = ',';
+    out = put_uint(out, snap.order_id);
+    if (columns & MBP_COLUMNS_CONFLATION) {
+        *out++ = ',';
+        out = put_uint(out, snap.conflated);
+        *out++ = ',';
+        out = put_uint(out, snap.bid_changed);
+        *out++ = ',';
+        out = put_uint(out, snap.ask_changed);
+    }
+    if (columns & MBP_COLUMNS_ANALYTICS) {
+        const BookFeatures &f = snap.features;
+        *out++ = ',';
+        if (f.two_sided) {
+            out = format_price(out, f.microprice, PRICE_SCALE_DIGITS);
+            *out++ = ',';
+            out = std::to_chars(out, out + 24, f.imbalance, std::chars_format::fixed, 6).ptr;
+            *out++ = ',';
+            out = format_price(out, f.wmid, PRICE_SCALE_DIGITS);
+        } else {
+            out = put(out, ",,"); // microprice, imbalance and wmid left empty
+        }
+        for (int64_t depth : { f.bid_depth_5, f.ask_depth_5, f.bid_depth_10, f.ask_depth_10 }) {
+            *out++ = ',';
+            out = put_int(out, depth);
+        }
+    }
+    *out++ = '\n';
+
+    used = out - buffer.data();
+}
+
+template void MbpCsvWriter::write_row(const MbpSnapshot<1> &);
+template void MbpCsvWriter::write_row(const MbpSnapshot<10> &);
+template void MbpCsvWriter::write_row(const MbpSnapshot<50> &);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mbp_snapshot.h"
+#include "timestamp.h"
+
+// Opens an MBP output file for writing. resume_at < 0 creates/truncates it;
+// otherwise the file must hold at least resume_at bytes and is cut back to
+// exactly that, positioned at the end. Throws on failure.
+int open_mbp_output(const std::string &path, int64_t resume_at);
+
+// MBP-N csv encoder. Rows are built with to_chars/format_price straight into
+// a large reusable buffer that goes out with a single write() when full.
+// Level triples that did not change since the previous row are copied from a
+// cache of their encoded text instead of being formatted again.
+class MbpCsvWriter {
+public:
+    // resume_at >= 0 reopens an existing output cut back to that many bytes
+    // (checkpoint restore) instead of truncating it; skip write_header then.
+    // depth is the level count of the header and of every row written,
+    // columns the MBP_COLUMNS_* set appended after order_id.
+    explicit MbpCsvWriter(const std::string &path, int64_t resume_at = -1, int depth = MBP_DEPTH, uint32_t columns = 0);
+    ~MbpCsvWriter();
+
+    MbpCsvWriter(const MbpCsvWriter &) = delete;
+    MbpCsvWriter &operator=(const MbpCsvWriter &) = delete;
+
+    void write_header();
+    template<int Depth>
+    void write_row(const MbpSnapshot<Depth> &snap);
+    void flush();
+
+    uint64_t bytes_written() const { return written; }
+
+private:
+    // encoded ",px,sz,ct" of one side/level as of the previous row
+    struct CachedLevel {
+        bool present = false;
+        MbpLevel level = { 0, 0, 0 };
+        int len = 0;
+        char text[64];
+    };
+
+    int fd = -1;
+    int depth;
+    uint32_t columns;
+    size_t max_row_size; // bound on one encoded row but its symbol, from depth and columns
+    std::vector<char> buffer;
+    size_t used = 0;
+    uint64_t written = 0;
+    CachedLevel cache[2][MBP_MAX_DEPTH];
+    TimestampFormatter timestamps;
+
+    char *encode_level(char *out, CachedLevel &cached, const MbpLevel *level);
+    void reserve(size_t bytes);
+};
@@ -0,0 +1,403 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "latency_stats.h"
+#include "mbo_parser.h"
+#include "price.h"
+#include "book_types.h"
+#include "book_side.h"
+#include "book_analytics.h"
+#include "order_table.h"
+#include "mbp_snapshot.h"
+#include "checkpoint.h"
+#include "tfc_sequencer.h"
+#include "trace.h"
+
+// One instrument's book. Records go in through on_mbo() (or load() for a
+// whole input), every top-Depth change comes out as an MbpSnapshot<Depth>
+// handed to output.write_row(). BookSide is MapBookSide or LadderBookSide
+// (book_side.h); Writer is any sink with write_row(const MbpSnapshot<Depth> &),
+// e.g. MbpCsvWriter, MbpColumnarWriter or MbpCallbackSink (mbp_engine.h). The
+// writer is owned by the caller.
+template<template<bool> class BookSide, typename Writer, int Depth = MBP_DEPTH>
+class OrderBook {
+public:
+    // levels shown in each snapshot row
+    static constexpr int BOOK_DEPTH = Depth;
+    // levels whose changes emit a row (book_side.h)
+    static constexpr int TOP_N = top_n_levels(Depth);
+
+    explicit OrderBook(Writer &output, const BookConfig &config = BookConfig())
+        : output_file(output), orders(config.order_capacity), bids(config), asks(config),
+          track_analytics(config.analytics) {
+        order_pool.reserve(config.order_capacity);
+    }
+
+    OrderBook(const OrderBook &) = delete;
+    OrderBook &operator=(const OrderBook &) = delete;
+
+    // feeds every record of reader (MboParser, MboBinaryReader) through the book
+    template<typename Reader>
+    void load(Reader &reader) {
+        MboRecord rec;
+
+        while (reader.next(rec)) {
+            on_mbo(rec);
+        }
+
+        finish();
+    }
+
+    void on_mbo(const MboRecord &row) {
+        add_to_buffer(row);
+    }
+
+    // Streaming: hand each row out as soon as the next record decides it,
+    // instead of the file-input window that keeps rows waiting for later
+    // input (tfc_sequencer.h).
+    void set_eager_tfc(bool on) { sequencer.set_eager(on); }
+
+    // rows held back for T-F-C matching
+    bool has_pending() const { return sequencer.pending_count() > 0; }
+
+    // end of input: process whatever is still held for T-F-C matching
+    void finish() {
+        // cleanup eof buffer
+        for (int i = 0; i < sequencer.pending_count(); i++) {
+            trace_eof_pending(sequencer.pending(i));
+        }
+        sequencer.finish();
+    }
+
+    // n best levels of each side, best first (n may exceed BOOK_DEPTH)
+    void top_levels(int n, std::vector<MbpLevel> &bid_levels, std::vector<MbpLevel> &ask_levels) const {
+        auto copy = [n](const auto &book, std::vector<MbpLevel> &out) {
+            out.clear();
+            book.for_each_level(n, [&](Price price, const PriceLevel &level) {
+                out.push_back({ price, level.total_size, level.order_count });
+            });
+        };
+        copy(bids, bid_levels);
+        copy(asks, ask_levels);
+    }
+
+    // resting orders (bids then asks, best level first, queue order), rows
+    // held for T-F-C matching and the next row number; see checkpoint.h
+    void save(BookState &state) const {
+        state.row_index = row_index;
+        state.orders.clear();
+        state.orders.reserve(orders.size());
+        auto save_side = [&](const auto &book) {
+            book.for_each_level(INT_MAX, [&](Price, const PriceLevel &level) {
+                for (uint32_t i = level.head; i != NO_ORDER; i = order_pool[i].next) {
+                    const Order &order = order_pool[i];
+                    CheckpointOrder saved = {};
+                    saved.order_id = order.order_id;
+                    saved.price = order.price;
+                    saved.size = order.size;
+                    saved.side = static_cast<uint8_t>(order.side);
+                    state.orders.push_back(saved);
+                }
+            });
+        };
+        save_side(bids);
+        save_side(asks);
+        state.pending.clear();
+        for (int i = 0; i < sequencer.pending_count(); i++) {
+            state.pending.push_back(sequencer.pending(i));
+        }
+    }
+
+    // rebuilds a saved book into this (empty) one
+    void restore(const BookState &state) {
+        orders.reserve(state.orders.size());
+        order_pool.reserve(state.orders.size());
+        for (const CheckpointOrder &saved : state.orders) {
+            Order order = { saved.order_id, static_cast<char>(saved.side), saved.price, saved.size };
+            uint32_t index = order_pool.allocate(order);
+            orders.insert(order.order_id, index);
+            if (order.side == 'A') {
+                add_to_level(asks.get_or_create(order.price), index);
+            } else {
+                add_to_level(bids.get_or_create(order.price), index);
+            }
+        }
+
+        // pending rows outlive the checkpoint they came from. Pushing them
+        // again rebuilds the sequencer state; an F left over from an open
+        // sweep is released on its own, which leaves the book as it was.
+        sequencer.restore_window(static_cast<int>(state.pending.size()));
+        for (const MboRecord &rec : state.pending) {
+            restored_symbols.emplace_back(rec.symbol);
+            MboRecord held = rec;
+            held.symbol = restored_symbols.back();
+            sequencer.push(held);
+        }
+        row_index = state.row_index;
+
+        if (track_analytics) {
+            analytics.bid.rebuild(bids);
+            analytics.ask.rebuild(asks);
+        }
+    }
+
+private:
+    friend class TfcSequencer<OrderBook>;
+
+    Writer &output_file;
+    OrderTable orders; // order_id -> slot in order_pool
+    OrderPool order_pool;
+    TfcSequencer<OrderBook> sequencer{ *this };
+    std::deque<std::string> restored_symbols; // symbols of restored pending rows
+    int row_index = 0;
+
+    // price -> level (order queue + running totals), best level first
+    BookSide<true> bids;
+    BookSide<false> asks;
+
+    // incremental per-row features, only kept with BookConfig::analytics
+    bool track_analytics;
+    BookAnalytics analytics;
+
+    void add_to_buffer(const MboRecord &row) {
+        if (row.action == 'T' && row.side == 'N') {
+            get_snapshot(row, 'T', 'N', 0, row.price, row.size, 0); // T, N combo
+            
+            return;
+        }
+
+        sequencer.push(row);
+    }
+
+    // TfcSequencer callbacks: a row outside any sweep, and one F-C pair of
+    // an aggressor's sweep
+    void on_plain(const MboRecord &row) {
+        process_row(row);
+    }
+
+    void on_sweep(const MboRecord &trade_row, const MboRecord &, const MboRecord &cancel_row) {
+        LATENCY_SCOPE(LatencyKind::TradeSequence, row_index);
+
+        trace_tfc(trade_row.side, cancel_row);
+        
+        process_row(cancel_row);
+    }
+
+    void process_row(const MboRecord &row) {
+        LATENCY_SCOPE(latency_kind(row.action), row_index);
+
+        trace_top_of_book(bids, asks, row);
+
+        char action = row.action;
+
+        if (action == 'R') {
+            get_snapshot(row, action, 'N', 0, 0, 0, 0);
+            return;
+        }
+
+        char side = row.side;
+
+        Price price = row.price;
+        int size = row.size;
+        uint64_t order_id = row.order_id;
+
+        bool book_changed = false;
+
+        switch(action) {
+            case 'A':
+                trace_order(TraceType::Add, row);
+                book_changed = add_order(order_id, price, side, size);
+                break;
+            
+            case 'C':
+                trace_order(TraceType::Cancel, row);
+                book_changed = cancel_order(order_id);
+                break;
+
+            case 'T':
+            case 'F':
+            default:
+                break;
+        }
+
+        if (!book_changed && trace_ring()) {
+            bool in_top = side == 'A' ? asks.in_top_n(price, TOP_N) : bids.in_top_n(price, TOP_N);
+            if (in_top) trace_missed_top(row, row_index, BOOK_DEPTH);
+        }
+
+        if (book_changed) {
+            int depth = calculate_depth(side, price);
+            get_snapshot(row, action, side, depth, price, size, order_id);
+        }
+    }
+
+    int calculate_depth(char side, Price price) {
+        if (side == 'B') {
+            // For bids, count levels above this price
+            return bids.rank(price);
+        } else if (side == 'A') {
+            // For asks, count levels below this price
+            return asks.rank(price);
+        }
+        
+        return 0;
+    }
+
+    void get_snapshot(const MboRecord &row, char action, char side, int depth, Price price, int size, uint64_t order_id) {
+        LATENCY_SCOPE(LatencyKind::Snapshot, row_index);
+
+        MbpSnapshot<Depth> snap;
+        snap.rec = &row;
+        snap.row_index = row_index;
+        snap.action = action;
+        snap.side = side;
+        snap.depth = depth;
+        snap.price = price;
+        snap.size = size;
+        snap.order_id = order_id;
+        snap.bid_count = collect_levels(bids, snap.bids);
+        snap.ask_count = collect_levels(asks, snap.asks);
+        if (track_analytics) {
+            snap.features = analytics.features();
+        }
+
+        trace_snapshot(snap);
+
+        // csv / columnar / delta output
+        output_file.write_row(snap);
+
+        row_index++;
+    }
+
+    bool add_order(uint64_t order_id, Price price, char side, int size) {
+        if (side != 'A' && side != 'B') return false;
+
+        // an add for a live order_id replaces the old order
+        if (orders.find(order_id) != NO_ORDER) {
+            cancel_order(order_id);
+        }
+
+        Order order = { order_id, side, price, size };
+        uint32_t index = order_pool.allocate(order);
+        orders.insert(order_id, index);
+        
+        if (side == 'A') {
+            return add_to_side(asks, analytics.ask, price, index);
+        } else {
+            return add_to_side(bids, analytics.bid, price, index);
+        }
+    }
+
+    // queues the order at its level, returns whether the level is visible
+    template<typename Side>
+    bool add_to_side(Side &book, SideAnalytics &stats, Price price, uint32_t index) {
+        PriceLevel &level = book.get_or_create(price);
+        bool new_level = level.order_count == 0;
+        add_to_level(level, index);
+
+        if (track_analytics) {
+            stats.apply(book, price, order_pool[index].size, new_level ? LevelChange::Insert : LevelChange::Size);
+        }
+
+        return book.in_top_n(price, TOP_N);
+    }
+
+    bool cancel_order(uint64_t order_id) {
+        uint32_t index = orders.find(order_id);
+        if (index == NO_ORDER) return false;
+
+        const Order &order_to_cancel = order_pool[index];
+        Price price = order_to_cancel.price;
+        char side = order_to_cancel.side;
+
+        bool book_changed = false;
+
+        if (side == 'A') {
+            book_changed = remove_from_side(asks, analytics.ask, price, index);
+        } else if (side == 'B') {
+            book_changed = remove_from_side(bids, analytics.bid, price, index);
+        }
+
+        orders.erase(order_id);
+        order_pool.release(index);
+
+        return book_changed;
+    }
+
+    // unlinks the order and drops its level once empty, returns whether the
+    // visible top of that side was touched
+    template<typename Side>
+    bool remove_from_side(Side &book, SideAnalytics &stats, Price price, uint32_t index) {
+        bool was_in_top = book.in_top_n(price, TOP_N);
+
+        if (PriceLevel *level = book.find(price)) {
+            remove_from_level(*level, index);
+            bool emptied = level->order_count == 0;
+            if (emptied) {
+                book.erase(price);
+            }
+
+            if (track_analytics) {
+                stats.apply(book, price, -order_pool[index].size, emptied ? LevelChange::Remove : LevelChange::Size);
+            }
+        }
+
+        bool is_in_top = book.in_top_n(price, TOP_N);
+
+        return was_in_top || is_in_top;
+    }
+
+    // CLASS HELP FUNCTIONS
+    // appends the order to the back of the level's queue; level totals are
+    // adjusted together with the queue, so snapshots never re-sum
+    void add_to_level(PriceLevel &level, uint32_t index) {
+        Order &order = order_pool[index];
+        order.prev = level.tail;
+        order.next = NO_ORDER;
+
+        if (level.tail != NO_ORDER) {
+            order_pool[level.tail].next = index;
+        } else {
+            level.head = index;
+        }
+        level.tail = index;
+
+        level.total_size += order.size;
+        level.order_count++;
+    }
+
+    // O(1) unlink, wherever the order sits in the queue
+    void remove_from_level(PriceLevel &level, uint32_t index) {
+        Order &order = order_pool[index];
+
+        if (order.prev != NO_ORDER) {
+            order_pool[order.prev].next = order.next;
+        } else {
+            level.head = order.next;
+        }
+        if (order.next != NO_ORDER) {
+            order_pool[order.next].prev = order.prev;
+        } else {
+            level.tail = order.prev;
+        }
+        order.prev = order.next = NO_ORDER;
+
+        level.total_size -= order.size;
+        level.order_count--;
+    }
+
+    // copies the best BOOK_DEPTH (px, sz, ct) triples of a side, returns how many
+    template<typename Side>
+    int collect_levels(const Side &book, MbpLevel *out) {
+        int count = 0;
+        book.for_each_level(BOOK_DEPTH, [&](Price price, const PriceLevel &level) {
+            out[count++] = { price, level.total_size, level.order_count };
+        });
+        return count;
+    }
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "book_types.h"
+
+// order_id -> OrderPool index. Open addressing with linear probing over one
+// flat array of (key, index) slots; NO_ORDER marks an empty slot. Erase uses
+// backward-shift deletion, so there are no tombstones and probe sequences
+// stay as short as the load allows. Grows by doubling at 1/2 load; pass the
+// expected live order count to the constructor (or reserve) to never rehash.
+class OrderTable {
+public:
+    explicit OrderTable(size_t capacity_hint = 0) { reserve(capacity_hint); }
+
+    // room for n live orders without rehashing
+    void reserve(size_t n) {
+        size_t capacity = MIN_CAPACITY;
+        while (capacity < 2 * n) capacity <<= 1;
+        if (capacity > slots.size()) rehash(capacity);
+    }
+
+    // pool index of order_id, or NO_ORDER
+    uint32_t find(uint64_t order_id) const {
+        for (size_t i = home(order_id);; i = (i + 1) & mask) {
+            const Slot &slot = slots[i];
+            if (slot.index == NO_ORDER) return NO_ORDER;
+            if (slot.key == order_id) return slot.index;
+        }
+    }
+
+    // inserts or overwrites
+    void insert(uint64_t order_id, uint32_t index) {
+        if (2 * (count + 1) > slots.size()) rehash(2 * slots.size());
+
+        for (size_t i = home(order_id);; i = (i + 1) & mask) {
+            Slot &slot = slots[i];
+            if (slot.index == NO_ORDER) {
+                slot = { order_id, index };
+                count++;
+                return;
+            }
+            if (slot.key == order_id) {
+                slot.index = index;
+                return;
+            }
+        }
+    }
+
+    // false if order_id was not present
+    bool erase(uint64_t order_id) {
+        size_t i = home(order_id);
+        while (true) {
+            if (slots[i].index == NO_ORDER) return false;
+            if (slots[i].key == order_id) break;
+            i = (i + 1) & mask;
+        }
+
+        // pull later entries of the cluster back into the hole unless that
+        // would move them before their home slot
+        size_t hole = i;
+        for (size_t j = (hole + 1) & mask; slots[j].index != NO_ORDER; j = (j + 1) & mask) {
+            size_t h = home(slots[j].key);
+            if (((j - h) & mask) >= ((j - hole) & mask)) {
+                slots[hole] = slots[j];
+                hole = j;
+            }
+        }
+        slots[hole].index = NO_ORDER;
+        count--;
+        return true;
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return slots.size() / 2; }
+
+private:
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    struct Slot {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    std::vector<Slot> slots;
+    size_t mask = 0;
+    size_t count = 0;
+
+    // murmur3 finalizer; venue order ids are often sequential
+    size_t home(uint64_t key) const {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key) & mask;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old(capacity, Slot{ 0, NO_ORDER });
+        old.swap(slots);
+        mask = capacity - 1;
+        count = 0;
+
+        for (const Slot &slot : old) {
+            if (slot.index != NO_ORDER) insert(slot.key, slot.index);
+        }
+    }
+};
@@ -0,0 +1,109 @@
+// Order id table benchmark: the previous std::unordered_map<int, uint32_t>
+// against OrderTable (order_table.h), with and without a capacity hint.
+//
+//   ./order_table_bench [live_orders] [seed]
+//
+// Each table gets live_orders inserts, the same number of lookups in random
+// order, add/cancel churn at constant size (random victim, new id), then
+// erases everything. Times are per operation; churn is one erase + one insert.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "order_table.h"
+
+// keeps the optimizer from dropping the lookups
+static volatile uint64_t sink;
+
+struct UnorderedMapTable {
+    std::unordered_map<int, uint32_t> map;
+
+    explicit UnorderedMapTable(size_t hint) { map.reserve(hint); }
+
+    uint32_t find(uint64_t id) const {
+        auto it = map.find(static_cast<int>(id));
+        return it == map.end() ? NO_ORDER : it->second;
+    }
+    void insert(uint64_t id, uint32_t index) { map[static_cast<int>(id)] = index; }
+    void erase(uint64_t id) { map.erase(static_cast<int>(id)); }
+};
+
+struct FlatTable {
+    OrderTable table;
+
+    explicit FlatTable(size_t hint) : table(hint) {}
+
+    uint32_t find(uint64_t id) const { return table.find(id); }
+    void insert(uint64_t id, uint32_t index) { table.insert(id, index); }
+    void erase(uint64_t id) { table.erase(id); }
+};
+
+template<typename Fn>
+static double ns_per_op(size_t ops, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(ops);
+}
+
+template<typename Table>
+static void run(const char *name, size_t hint, const std::vector<uint64_t> &ids,
+                const std::vector<uint64_t> &lookups, const std::vector<uint64_t> &fresh) {
+    size_t n = ids.size();
+    Table table(hint);
+    uint64_t checksum = 0;
+
+    double insert = ns_per_op(n, [&] {
+        for (size_t i = 0; i < n; i++) table.insert(ids[i], static_cast<uint32_t>(i));
+    });
+    double find = ns_per_op(n, [&] {
+        for (uint64_t id : lookups) checksum += table.find(id);
+    });
+    // cancel a random live order, add a new one
+    double churn = ns_per_op(n, [&] {
+        for (size_t i = 0; i < n; i++) {
+            table.erase(lookups[i]);
+            table.insert(fresh[i], static_cast<uint32_t>(i));
+        }
+    });
+    double erase = ns_per_op(n, [&] {
+        for (uint64_t id : fresh) table.erase(id);
+    });
+
+    sink = checksum;
+    std::cout << name << ": insert " << insert << " ns, find " << find << " ns, churn " << churn
+              << " ns, erase " << erase << " ns" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    uint64_t seed = argc > 2 ? std::stoull(argv[2]) : 1;
+
+    // sequential-ish venue ids with gaps, kept below 2^31 for the int map
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> ids(2 * n);
+    uint64_t next = 1000000;
+    for (uint64_t &id : ids) {
+        next += 1 + rng() % 8;
+        id = next;
+    }
+    std::vector<uint64_t> fresh(ids.begin() + n, ids.end());
+    ids.resize(n);
+
+    std::vector<uint64_t> lookups = ids;
+    std::shuffle(lookups.begin(), lookups.end(), rng);
+
+    std::cout << n << " live orders" << std::endl;
+    run<UnorderedMapTable>("unordered_map       ", 0, ids, lookups, fresh);
+    run<UnorderedMapTable>("unordered_map+hint  ", n, ids, lookups, fresh);
+    run<FlatTable>("OrderTable          ", 0, ids, lookups, fresh);
+    run<FlatTable>("OrderTable+hint     ", n, ids, lookups, fresh);
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Parser throughput benchmark: getline/stringstream tokenizing (the original
+// load_csv path) against the memory-mapped MboParser.
+//
+//   ./parse_bench [mbo.csv] [iterations]
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mbo_parser.h"
+
+// keeps the optimizer from dropping the parsed values
+static volatile long long sink;
+
+static size_t run_legacy(const std::string &filename) {
+    std::ifstream file(filename);
+    std::string line;
+    size_t rows = 0;
+    long long checksum = 0;
+
+    std::getline(file, line);
+
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string cell;
+        std::vector<std::string> row;
+
+        while (std::getline(ss, cell, ',')) {
+            row.push_back(cell);
+        }
+
+        // same conversions add_to_buffer/process_row did per row
+        if (row[5][0] != 'R') {
+            checksum += static_cast<long long>(std::stod(row[7]));
+            checksum += std::stoi(row[8]) + std::stoi(row[10]);
+        }
+        rows++;
+    }
+
+    sink = checksum;
+    return rows;
+}
+
+static size_t run_mmap(const std::string &filename) {
+    MboParser parser(filename);
+    MboRecord rec;
+    long long checksum = 0;
+
+    parser.skip_header();
+    while (parser.next(rec)) {
+        checksum += static_cast<long long>(rec.price) + rec.size + rec.order_id;
+    }
+
+    sink = checksum;
+    return parser.rows();
+}
+
+template<typename Fn>
+static void report(const char *name, Fn fn, const std::string &filename, size_t file_bytes, int iterations) {
+    size_t rows = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        rows += fn(filename);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double gbytes = static_cast<double>(file_bytes) * iterations / 1e9;
+
+    std::cout << name << ": " << rows / seconds << " rows/s, "
+              << gbytes / seconds << " GB/s (" << seconds << " s)" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::string filename = argc > 1 ? argv[1] : "mbo.csv";
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 200;
+
+    size_t file_bytes = 0;
+    try {
+        file_bytes = MboParser(filename).bytes();
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << filename << ": " << file_bytes << " bytes x " << iterations << " iterations" << std::endl;
+    report("getline/stringstream", run_legacy, filename, file_bytes, iterations);
+    report("mmap/simd          ", run_mmap, filename, file_bytes, iterations);
+
+    return 0;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <charconv>
+#include <cstring>
+#include <system_error>
+
+// Whole-string numeric flag value (integers, and doubles for the tools that
+// take rates); false on junk, trailing text, a sign on an unsigned type or
+// overflow. Callers fall through to their usage message on false.
+template<typename T>
+inline bool parse_number(const char *text, T &value) {
+    const char *end = text + std::strlen(text);
+    auto [ptr, ec] = std::from_chars(text, end, value);
+    return ec == std::errc() && ptr == end && ptr != text;
+}
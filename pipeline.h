@@ -0,0 +1,250 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "book_side.h"
+#include "mbo_parser.h"
+#include "mbp_snapshot.h"
+#include "order_book.h"
+#include "spsc_ring.h"
+
+// Three-stage pipeline for one book:
+//
+//   parse thread  --records ring-->  book thread  --snapshots ring-->  write thread
+//
+// The parse stage runs the reader, the book stage runs OrderBook::load over
+// the records ring and the write stage formats rows with the real Writer, so
+// parsing, book updates and formatting overlap instead of adding up. Output
+// is identical to the single-threaded path.
+//
+// A stage that throws (a corrupt compressed input, a failed write) still
+// passes the end-of-input slot on and drains its input ring, so the other
+// stages finish; load() rethrows the first error on the calling thread.
+
+struct PipelineConfig {
+    size_t record_ring = 1 << 14;  // slots between parse and book
+    size_t snapshot_ring = 1 << 12; // slots between book and write
+    int cpus[3] = { -1, -1, -1 };   // parse, book, write; -1 = not pinned
+};
+
+// Time a stage spends running vs waiting on its neighbours.
+struct StageStats {
+    const char *name = "";
+    uint64_t items = 0;
+    double wall = 0;    // seconds from stage start to stage end
+    double starved = 0; // waiting for input
+    double blocked = 0; // waiting for room downstream
+
+    double utilization() const {
+        return wall > 0 ? (wall - starved - blocked) / wall : 0;
+    }
+};
+
+inline void print_stage_stats(std::ostream &out, const StageStats &s) {
+    out << "  " << s.name << ": " << s.utilization() * 100 << "% busy, " << s.items << " items, "
+        << s.starved << " s starved, " << s.blocked << " s blocked (" << s.wall << " s)" << std::endl;
+}
+
+// best effort, returns false where affinity is unsupported or refused
+inline bool pin_thread(std::thread &thread, int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    (void)thread;
+    (void)cpu;
+    return false;
+#endif
+}
+
+template<template<bool> class BookSide, typename Writer, int Depth = MBP_DEPTH>
+class Pipeline {
+public:
+    Pipeline(Writer &output, const PipelineConfig &config, const BookConfig &book_config = BookConfig())
+        : output(output), config(config), book_config(book_config),
+          records(config.record_ring), snapshots(config.snapshot_ring) {
+        stats[0].name = "parse";
+        stats[1].name = "book ";
+        stats[2].name = "write";
+    }
+
+    template<typename Reader>
+    void load(Reader &reader) {
+        std::thread threads[3] = {
+            std::thread([this, &reader] { parse_stage(reader); }),
+            std::thread([this] { book_stage(); }),
+            std::thread([this] { write_stage(); }),
+        };
+
+        for (int i = 0; i < 3; i++) {
+            if (config.cpus[i] >= 0 && !pin_thread(threads[i], config.cpus[i])) {
+                std::cerr << "Warning: could not pin " << stats[i].name << " stage to cpu " << config.cpus[i] << std::endl;
+            }
+        }
+        for (std::thread &t : threads) {
+            t.join();
+        }
+        for (const std::exception_ptr &error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+    }
+
+    void print_stats(std::ostream &out) const {
+        out << "Pipeline stages:" << std::endl;
+        for (const StageStats &s : stats) {
+            print_stage_stats(out, s);
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct RecordSlot {
+        MboRecord rec;
+        bool end;
+    };
+
+    // compact copy of one output row; rec is re-pointed at the copy on the write side
+    struct SnapshotSlot {
+        MboRecord rec;
+        MbpSnapshot<Depth> snap;
+        bool end;
+    };
+
+    // OrderBook::load reads the records ring through this
+    struct RingReader {
+        Pipeline &p;
+
+        bool next(MboRecord &rec) {
+            RecordSlot slot;
+            p.timed_pop(p.records, slot, p.stats[1]);
+            if (slot.end) {
+                p.records_done = true;
+                return false;
+            }
+            rec = slot.rec;
+            return true;
+        }
+    };
+
+    // ...and writes its rows through this
+    struct RingSink {
+        Pipeline &p;
+
+        void write_row(const MbpSnapshot<Depth> &snap) {
+            SnapshotSlot slot;
+            slot.rec = *snap.rec;
+            slot.snap = snap;
+            slot.end = false;
+            p.timed_push(p.snapshots, slot, p.stats[1]);
+        }
+    };
+
+    Writer &output;
+    PipelineConfig config;
+    BookConfig book_config;
+    SpscRing<RecordSlot> records;
+    SpscRing<SnapshotSlot> snapshots;
+    StageStats stats[3];
+    std::exception_ptr errors[3]; // per stage, set before the stage finishes
+    bool records_done = false;    // book stage has seen the end slot
+
+    static double seconds_since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // the clock is only read when the fast path fails
+    template<typename T>
+    void timed_push(SpscRing<T> &ring, const T &value, StageStats &s) {
+        if (ring.try_push(value)) return;
+        auto start = Clock::now();
+        ring.push(value);
+        s.blocked += seconds_since(start);
+    }
+
+    template<typename T>
+    void timed_pop(SpscRing<T> &ring, T &value, StageStats &s) {
+        if (ring.try_pop(value)) return;
+        auto start = Clock::now();
+        ring.pop(value);
+        s.starved += seconds_since(start);
+    }
+
+    template<typename Reader>
+    void parse_stage(Reader &reader) {
+        auto start = Clock::now();
+        RecordSlot slot;
+        slot.end = false;
+
+        try {
+            while (reader.next(slot.rec)) {
+                timed_push(records, slot, stats[0]);
+                stats[0].items++;
+            }
+        } catch (...) {
+            errors[0] = std::current_exception();
+        }
+
+        slot.end = true;
+        timed_push(records, slot, stats[0]);
+        stats[0].wall = seconds_since(start);
+    }
+
+    void book_stage() {
+        auto start = Clock::now();
+        RingReader reader{ *this };
+        RingSink sink{ *this };
+        try {
+            OrderBook<BookSide, RingSink, Depth> book(sink, book_config);
+            book.load(reader);
+        } catch (...) {
+            errors[1] = std::current_exception();
+            // unblock the parse stage
+            RecordSlot rest;
+            while (!records_done) {
+                records.pop(rest);
+                records_done = rest.end;
+            }
+        }
+
+        SnapshotSlot slot;
+        slot.end = true;
+        timed_push(snapshots, slot, stats[1]);
+        stats[1].items = stats[0].items;
+        stats[1].wall = seconds_since(start);
+    }
+
+    void write_stage() {
+        auto start = Clock::now();
+        SnapshotSlot slot;
+
+        try {
+            while (true) {
+                timed_pop(snapshots, slot, stats[2]);
+                if (slot.end) break;
+                slot.snap.rec = &slot.rec;
+                output.write_row(slot.snap);
+                stats[2].items++;
+            }
+            output.flush();
+        } catch (...) {
+            errors[2] = std::current_exception();
+            // unblock the book stage
+            while (!slot.end) {
+                snapshots.pop(slot);
+            }
+        }
+        stats[2].wall = seconds_since(start);
+    }
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+
+// Fixed-point price: int64 count of 10^-PRICE_SCALE_DIGITS ticks. The default
+// of 9 digits matches the MBO feed precision (e.g. 5.510000000).
+#ifndef PRICE_SCALE_DIGITS
+#define PRICE_SCALE_DIGITS 9
+#endif
+
+typedef int64_t Price;
+
+constexpr int64_t pow10_i64(int digits) {
+    int64_t value = 1;
+    for (int i = 0; i < digits; i++) value *= 10;
+    return value;
+}
+
+constexpr Price PRICE_SCALE = pow10_i64(PRICE_SCALE_DIGITS);
+
+// Parses decimal text straight into ticks. Digits beyond the scale are
+// truncated, empty text is 0.
+inline Price parse_price(std::string_view s) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < s.size() && (s[i] == '-' || s[i] == '+')) {
+        negative = s[i] == '-';
+        i++;
+    }
+
+    int64_t whole = 0;
+    for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; i++) {
+        whole = whole * 10 + (s[i] - '0');
+    }
+
+    int64_t frac = 0;
+    int frac_digits = 0;
+    if (i < s.size() && s[i] == '.') {
+        for (i++; i < s.size() && s[i] >= '0' && s[i] <= '9'; i++) {
+            if (frac_digits < PRICE_SCALE_DIGITS) {
+                frac = frac * 10 + (s[i] - '0');
+                frac_digits++;
+            }
+        }
+    }
+
+    Price ticks = whole * PRICE_SCALE + frac * pow10_i64(PRICE_SCALE_DIGITS - frac_digits);
+    return negative ? -ticks : ticks;
+}
+
+inline double price_to_double(Price price) {
+    return static_cast<double>(price) / static_cast<double>(PRICE_SCALE);
+}
+
+// Writes the price with a fixed number of decimals and returns the end of the
+// text. Needs at most 24 bytes. Prices that are not exact at that precision
+// (e.g. a 13.575 trade at 2 decimals) are rounded through the double, the
+// same way std::fixed output did, so snapshots stay byte-identical.
+inline char *format_price(char *out, Price price, int decimals = 2) {
+    if (decimals > PRICE_SCALE_DIGITS) decimals = PRICE_SCALE_DIGITS;
+    const int64_t unit = pow10_i64(PRICE_SCALE_DIGITS - decimals);
+    const int64_t frac_scale = pow10_i64(decimals);
+
+    if (price % unit != 0) {
+        return out + std::snprintf(out, 24, "%.*f", decimals, price_to_double(price));
+    }
+
+    if (price < 0) {
+        *out++ = '-';
+        price = -price;
+    }
+    const int64_t rounded = price / unit;
+
+    int64_t whole = rounded / frac_scale;
+    int64_t frac = rounded % frac_scale;
+
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + whole % 10);
+        whole /= 10;
+    } while (whole > 0);
+    while (n > 0) *out++ = digits[--n];
+
+    if (decimals > 0) {
+        *out++ = '.';
+        for (int i = decimals - 1; i >= 0; i--) {
+            out[i] = static_cast<char>('0' + frac % 10);
+            frac /= 10;
+        }
+        out += decimals;
+    }
+    return out;
+}
@@ -0,0 +1,84 @@
+#include "replay_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+ReplayIndexWriter::ReplayIndexWriter(const std::string &path, CheckpointInput input_format, uint64_t input_size)
+    : path(path), out(path, std::ios::binary | std::ios::trunc), header() {
+    if (!out) {
+        throw std::runtime_error("cannot open " + path);
+    }
+
+    std::memcpy(header.magic, REPLAY_INDEX_MAGIC, sizeof(header.magic));
+    header.version = REPLAY_INDEX_VERSION;
+    header.price_scale_digits = PRICE_SCALE_DIGITS;
+    header.input_format = static_cast<uint32_t>(input_format);
+    header.input_size = input_size;
+
+    // placeholder until finish() knows the entry table
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    offset = sizeof(header);
+}
+
+void ReplayIndexWriter::add(int64_t max_ts_event, const Checkpoint &checkpoint) {
+    std::string data = encode_checkpoint(checkpoint);
+    out.write(data.data(), data.size());
+    if (!out) {
+        throw std::runtime_error("index write to " + path + " failed");
+    }
+
+    table.push_back({ max_ts_event, checkpoint.records_read, offset, data.size() });
+    offset += data.size();
+}
+
+void ReplayIndexWriter::finish() {
+    header.entry_count = static_cast<uint32_t>(table.size());
+    header.entries_offset = offset;
+
+    out.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(ReplayIndexEntry));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("index write to " + path + " failed");
+    }
+}
+
+ReplayIndex::ReplayIndex(const std::string &path) : path(path), file(path) {
+    if (file.size() < sizeof(header)) {
+        throw std::runtime_error(path + ": not a replay index");
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, REPLAY_INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != REPLAY_INDEX_VERSION) {
+        throw std::runtime_error(path + ": not a replay index (version " + std::to_string(REPLAY_INDEX_VERSION) + ")");
+    }
+    if (header.price_scale_digits != PRICE_SCALE_DIGITS) {
+        throw std::runtime_error(path + ": price scale mismatch, index uses " +
+                                 std::to_string(header.price_scale_digits) + " digits");
+    }
+    if (header.entry_count == 0 ||
+        header.entries_offset + header.entry_count * sizeof(ReplayIndexEntry) != file.size()) {
+        throw std::runtime_error(path + ": truncated replay index");
+    }
+
+    entries = reinterpret_cast<const ReplayIndexEntry *>(file.data() + header.entries_offset);
+}
+
+size_t ReplayIndex::find(int64_t ts) const {
+    const ReplayIndexEntry *end = entries + header.entry_count;
+    const ReplayIndexEntry *it = std::upper_bound(entries + 1, end, ts,
+        [](int64_t t, const ReplayIndexEntry &e) { return t < e.max_ts_event; });
+    return static_cast<size_t>(it - entries) - 1;
+}
+
+void ReplayIndex::checkpoint(size_t i, Checkpoint &checkpoint) const {
+    const ReplayIndexEntry &e = entries[i];
+    if (e.checkpoint_offset + e.checkpoint_size > header.entries_offset) {
+        throw std::runtime_error(path + ": corrupt replay index entry " + std::to_string(i));
+    }
+    decode_checkpoint(std::string_view(file.data() + e.checkpoint_offset, e.checkpoint_size), checkpoint,
+                      path + " entry " + std::to_string(i));
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "book_side.h"
+#include "checkpoint.h"
+#include "mapped_file.h"
+#include "mbo_parser.h"
+#include "mbp_snapshot.h"
+#include "order_book.h"
+
+// Sidecar index over an MBO input for "book at time T" queries (mbo_query).
+// Layout (little-endian):
+//
+//   ReplayIndexHeader
+//   book checkpoints, checkpoint.h format, back to back
+//   ReplayIndexEntry x entry_count      at entries_offset, ascending
+//
+// Entry 0 is the empty book at the first record. A query for T starts from
+// the last entry whose max_ts_event <= T and replays the input from its
+// offset until the first record with ts_event > T; the answer is the book
+// with every record before that one applied.
+
+constexpr char REPLAY_INDEX_MAGIC[8] = { 'M', 'B', 'O', 'I', 'D', 'X', '0', '1' };
+constexpr uint32_t REPLAY_INDEX_VERSION = 1;
+
+struct ReplayIndexHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t price_scale_digits;
+    uint32_t input_format;   // CheckpointInput
+    uint32_t entry_count;
+    uint64_t input_size;
+    uint64_t entries_offset;
+};
+static_assert(sizeof(ReplayIndexHeader) == 40, "ReplayIndexHeader layout");
+
+struct ReplayIndexEntry {
+    int64_t max_ts_event;    // highest ts_event of the records before it
+    uint64_t records;        // records applied
+    uint64_t checkpoint_offset;
+    uint64_t checkpoint_size;
+};
+static_assert(sizeof(ReplayIndexEntry) == 32, "ReplayIndexEntry layout");
+
+struct ReplayIndexConfig {
+    uint64_t every = 100000;  // records between entries, 0: time only
+    int64_t interval_ns = 0;  // ts_event span between entries, 0: count only
+};
+
+// Sink for books that only need their state, not their rows.
+struct MbpNullWriter {
+    template<int Depth>
+    void write_row(const MbpSnapshot<Depth> &) {}
+};
+
+// Streams checkpoints to path as they are added; finish() writes the entry
+// table and the final header. Throws on write errors.
+class ReplayIndexWriter {
+public:
+    ReplayIndexWriter(const std::string &path, CheckpointInput input_format, uint64_t input_size);
+
+    void add(int64_t max_ts_event, const Checkpoint &checkpoint);
+    void finish();
+
+    size_t entries() const { return table.size(); }
+
+private:
+    std::string path;
+    std::ofstream out;
+    ReplayIndexHeader header;
+    std::vector<ReplayIndexEntry> table;
+    uint64_t offset = 0;
+};
+
+// Memory-mapped index, shared read-only by query threads.
+class ReplayIndex {
+public:
+    explicit ReplayIndex(const std::string &path);
+
+    CheckpointInput input_format() const { return static_cast<CheckpointInput>(header.input_format); }
+    uint64_t input_size() const { return header.input_size; }
+    size_t size() const { return header.entry_count; }
+    const ReplayIndexEntry &entry(size_t i) const { return entries[i]; }
+
+    // last entry usable for a query at ts (entry 0 if none is later)
+    size_t find(int64_t ts) const;
+
+    void checkpoint(size_t i, Checkpoint &checkpoint) const;
+
+private:
+    std::string path;
+    MappedFile file;
+    ReplayIndexHeader header;
+    const ReplayIndexEntry *entries = nullptr;
+};
+
+// Indexing pass: runs the whole input through a book with no output and adds
+// an entry every config.every records and/or config.interval_ns of ts_event.
+template<template<bool> class BookSide, typename Reader>
+size_t build_replay_index(Reader &reader, CheckpointInput input_format, const std::string &path,
+                          const ReplayIndexConfig &config, const BookConfig &book_config) {
+    MbpNullWriter sink;
+    OrderBook<BookSide, MbpNullWriter> book(sink, book_config);
+    ReplayIndexWriter index(path, input_format, reader.bytes());
+
+    Checkpoint cp;
+    cp.input_format = input_format;
+    cp.input_size = reader.bytes();
+
+    int64_t max_ts = INT64_MIN;
+    auto add = [&]() {
+        cp.input_offset = reader.offset();
+        book.save(cp.book);
+        index.add(max_ts, cp);
+    };
+    add();
+
+    uint64_t next_count = config.every > 0 ? config.every : UINT64_MAX;
+    int64_t next_ts = INT64_MAX;
+
+    MboRecord rec;
+    while (reader.next(rec)) {
+        book.on_mbo(rec);
+        cp.records_read++;
+        cp.last_ts_event = rec.ts_event;
+        cp.last_sequence = rec.sequence;
+        if (rec.ts_event > max_ts) max_ts = rec.ts_event;
+
+        if (config.interval_ns > 0 && next_ts == INT64_MAX) {
+            next_ts = max_ts + config.interval_ns;
+        }
+        if (cp.records_read >= next_count || max_ts >= next_ts) {
+            add();
+            if (config.every > 0) next_count = cp.records_read + config.every;
+            if (config.interval_ns > 0) next_ts = max_ts + config.interval_ns;
+        }
+    }
+
+    index.finish();
+    return index.entries();
+}
+
+// One answered query: the book after every record before the first one with
+// ts_event > query_ts.
+struct BookAtTime {
+    int64_t query_ts = 0;
+    int64_t ts_event = 0;    // of the last applied record, 0 if none
+    uint32_t sequence = 0;
+    uint64_t records = 0;    // records applied
+    std::vector<MbpLevel> bids;
+    std::vector<MbpLevel> asks;
+};
+
+// Restores the nearest preceding checkpoint and replays only the gap. The
+// reader must be this thread's own, over the indexed input.
+template<template<bool> class BookSide, typename Reader>
+BookAtTime query_book_at(const ReplayIndex &index, Reader &reader, int64_t ts, int depth,
+                         const BookConfig &book_config) {
+    Checkpoint cp;
+    index.checkpoint(index.find(ts), cp);
+
+    MbpNullWriter sink;
+    OrderBook<BookSide, MbpNullWriter> book(sink, book_config);
+    book.restore(cp.book);
+    reader.seek(cp.input_offset);
+
+    BookAtTime result;
+    result.query_ts = ts;
+    result.ts_event = cp.last_ts_event;
+    result.sequence = cp.last_sequence;
+    result.records = cp.records_read;
+
+    MboRecord rec;
+    while (reader.next(rec) && rec.ts_event <= ts) {
+        book.on_mbo(rec);
+        result.ts_event = rec.ts_event;
+        result.sequence = rec.sequence;
+        result.records++;
+    }
+    book.finish();
+
+    book.top_levels(depth, result.bids, result.asks);
+    return result;
+}
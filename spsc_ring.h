@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Bounded lock-free single-producer/single-consumer ring. Capacity is rounded
+// up to a power of two. try_push/try_pop never block; push/pop spin and then
+// yield until they succeed. head/tail sit on separate cache lines and each
+// side keeps a cached copy of the other's index, so the shared lines are only
+// touched when the ring looks full (producer) or empty (consumer).
+template<typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    bool try_push(const T &value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head_cache == capacity()) {
+            head_cache = head.load(std::memory_order_acquire);
+            if (t - head_cache == capacity()) return false;
+        }
+        slots[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T &value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail_cache) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (h == tail_cache) return false;
+        }
+        value = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // blocking variants; the spin count before yielding keeps hand-offs cheap
+    // when both sides are running
+    void push(const T &value) {
+        for (int spins = 0; !try_push(value); spins++) {
+            if (spins > 64) std::this_thread::yield();
+        }
+    }
+
+    void pop(T &value) {
+        for (int spins = 0; !try_pop(value); spins++) {
+            if (spins > 64) std::this_thread::yield();
+        }
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask = 0;
+
+    alignas(64) std::atomic<size_t> head{0}; // next slot to read, owned by the consumer
+    size_t tail_cache = 0;                   // consumer's view of tail
+
+    alignas(64) std::atomic<size_t> tail{0}; // next slot to write, owned by the producer
+    size_t head_cache = 0;                   // producer's view of head
+};
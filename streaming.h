@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "book_side.h"
+#include "mbo_stream.h"
+#include "mbp_snapshot.h"
+#include "order_book.h"
+
+// Live mode: records are applied as they arrive and rows go out as soon as
+// they are determined. The output is flushed whenever the input has nothing
+// complete buffered, i.e. right before the reader could block.
+
+struct StreamConfig {
+    int tfc_timeout_ms = 10; // max wait for the rest of a T-F-C before giving up on it
+    bool measure_latency = false;
+};
+
+// Writer adapter that timestamps rows when they are actually written out and
+// keeps now - ts_recv per row. Meaningful when the sender stamps ts_recv with
+// its send time (mbo_replay --stamp).
+template<typename Writer>
+class LatencyRecorder {
+public:
+    LatencyRecorder(Writer &output, bool enabled) : output(output), enabled(enabled) {}
+
+    template<int Depth>
+    void write_row(const MbpSnapshot<Depth> &snap) {
+        output.write_row(snap);
+        if (enabled) pending.push_back(snap.rec->ts_recv);
+    }
+
+    void flush() {
+        output.flush();
+        if (pending.empty()) return;
+
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        for (int64_t ts_recv : pending) {
+            samples.push_back(now - ts_recv);
+        }
+        pending.clear();
+    }
+
+    void print_summary(std::ostream &out) {
+        if (samples.empty()) return;
+
+        std::sort(samples.begin(), samples.end());
+        auto at = [&](double q) { return samples[static_cast<size_t>(q * (samples.size() - 1))] / 1000.0; };
+        out << "Latency ts_recv -> write (us): p50 " << at(0.5) << ", p99 " << at(0.99)
+            << ", p99.9 " << at(0.999) << ", max " << samples.back() / 1000.0
+            << " (" << samples.size() << " rows)" << std::endl;
+    }
+
+private:
+    Writer &output;
+    bool enabled;
+    std::vector<int64_t> pending;
+    std::vector<int64_t> samples;
+};
+
+template<template<bool> class BookSide, int Depth = MBP_DEPTH, typename Writer>
+void run_stream(MboStreamReader &reader, Writer &output, const StreamConfig &config,
+                const BookConfig &book_config, std::ostream &log) {
+    LatencyRecorder<Writer> sink(output, config.measure_latency);
+    OrderBook<BookSide, LatencyRecorder<Writer>, Depth> book(sink, book_config);
+    book.set_eager_tfc(true);
+
+    MboRecord rec;
+    while (true) {
+        if (!reader.ready()) sink.flush();
+
+        int timeout_ms = book.has_pending() ? config.tfc_timeout_ms : -1;
+        StreamStatus status = reader.next(rec, timeout_ms);
+
+        if (status == StreamStatus::Record) {
+            book.on_mbo(rec);
+        } else if (status == StreamStatus::Timeout) {
+            // no F/C in time, the held rows are processed on their own
+            book.finish();
+        } else {
+            break;
+        }
+    }
+
+    book.finish();
+    sink.flush();
+    sink.print_summary(log);
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "mbo_parser.h"
+
+// Trade / fill / cancel matching as a state machine over parsed records. An
+// aggressor shows up as a T followed by one or more F-C pairs (one per
+// resting order it hits); the C of each pair is what changes the book. Rows
+// that may still belong to a sweep are held in a small inline buffer, by
+// value (MboRecord is fixed-size, its symbol a view into the input), and are
+// decided as soon as the next record arrives:
+//
+//   Idle       T -> Trade            else plain
+//   Trade      F -> TradeFill        else release T, then as Idle
+//   TradeFill  C -> sweep(T, F, C)   else release T F, then as Idle
+//   Sweep      F -> SweepFill        else as Idle
+//   SweepFill  C -> sweep(T, F, C)   else release F, then as Idle
+//
+// Handler provides on_plain(rec) and on_sweep(trade, fill, cancel). In Sweep
+// the trade row is no longer held; on_sweep gets the last one seen.
+//
+// File input keeps the release order of the original three-row window: from
+// a T until the next sweep, every row waits until two later rows have
+// arrived, even once it is decided, so T/N rows (which bypass the sequencer)
+// are written ahead of the rows still waiting. Streaming (set_eager) hands a
+// decided row out at once.
+template<typename Handler>
+class TfcSequencer {
+public:
+    explicit TfcSequencer(Handler &handler) : handler(handler) {}
+
+    void set_eager(bool on) { eager = on; }
+
+    void push(const MboRecord &rec) {
+        if (!continue_sweep(rec)) {
+            release();
+            if (rec.action == 'T') {
+                trade = rec;
+                lagging = !eager;
+                hold(rec, State::Trade);
+            } else {
+                emit(rec);
+            }
+        }
+
+        while (lagged_count > 0 && lagged_count + held_count > WINDOW) {
+            pop_lagged();
+        }
+    }
+
+    // hands every held row to on_plain (end of input, stream timeout)
+    void finish() {
+        while (lagged_count > 0) pop_lagged();
+        lagging = false;
+        release();
+    }
+
+    // before pushing back count rows saved from pending() (checkpoint
+    // restore): only a window left lagging behind a T is full
+    void restore_window(int count) { lagging = !eager && count >= WINDOW; }
+
+    // rows held back, oldest first
+    int pending_count() const { return lagged_count + held_count; }
+    const MboRecord &pending(int i) const { return i < lagged_count ? lagged[i] : held[i - lagged_count]; }
+
+private:
+    enum class State { Idle, Trade, TradeFill, Sweep, SweepFill };
+
+    // T F is the most a decision ever waits on
+    static constexpr int MAX_HELD = 2;
+    // rows the file-input window keeps back
+    static constexpr int WINDOW = 2;
+
+    Handler &handler;
+    State state = State::Idle;
+    MboRecord held[MAX_HELD];
+    int held_count = 0;
+    MboRecord trade; // T of the open sweep
+
+    bool eager = false;
+    bool lagging = false;           // released rows wait in lagged
+    MboRecord lagged[WINDOW + 1];   // decided plain rows, oldest first
+    int lagged_count = 0;
+
+    // true if rec was taken as the next F or C of the open trade / sweep
+    bool continue_sweep(const MboRecord &rec) {
+        switch (state) {
+            case State::Trade:
+                if (rec.action == 'F') {
+                    hold(rec, State::TradeFill);
+                    return true;
+                }
+                return false;
+
+            case State::TradeFill:
+            case State::SweepFill:
+                if (rec.action == 'C') {
+                    while (lagged_count > 0) pop_lagged(); // none: T F filled the window
+                    handler.on_sweep(trade, held[held_count - 1], rec);
+                    held_count = 0;
+                    lagging = false;
+                    state = State::Sweep;
+                    return true;
+                }
+                return false;
+
+            case State::Sweep:
+                if (rec.action == 'F') {
+                    hold(rec, State::SweepFill);
+                    return true;
+                }
+                state = State::Idle;
+                return false;
+
+            case State::Idle:
+                return false;
+        }
+        return false;
+    }
+
+    void hold(const MboRecord &rec, State next) {
+        held[held_count++] = rec;
+        state = next;
+    }
+
+    void emit(const MboRecord &rec) {
+        if (lagging) {
+            lagged[lagged_count++] = rec;
+        } else {
+            handler.on_plain(rec);
+        }
+    }
+
+    void pop_lagged() {
+        handler.on_plain(lagged[0]);
+        lagged_count--;
+        for (int i = 0; i < lagged_count; i++) {
+            lagged[i] = lagged[i + 1];
+        }
+    }
+
+    void release() {
+        for (int i = 0; i < held_count; i++) {
+            emit(held[i]);
+        }
+        held_count = 0;
+        state = State::Idle;
+    }
+};
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Timestamps are carried as int64 nanoseconds since the Unix epoch (UTC) and
+// only rendered back to ISO-8601 ("2025-07-17T08:05:03.360677248Z") on output.
+
+constexpr int TIMESTAMP_TEXT_SIZE = 30;
+constexpr int64_t NANOS_PER_SECOND = 1000000000;
+constexpr int64_t SECONDS_PER_DAY = 86400;
+
+// days since 1970-01-01 for a proleptic Gregorian date
+constexpr int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+inline void civil_from_days(int64_t z, int64_t &y, unsigned &m, unsigned &d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+// "YYYY-MM-DDTHH:MM:SS[.fraction]Z" -> epoch ns. Empty or short text is 0.
+// Any fraction length; parse_timestamp() below is the fast path for feeds.
+inline int64_t parse_timestamp_generic(std::string_view s) {
+    if (s.size() < 19) return 0;
+
+    auto num = [&](size_t pos, size_t len) {
+        int64_t value = 0;
+        for (size_t i = pos; i < pos + len; i++) value = value * 10 + (s[i] - '0');
+        return value;
+    };
+
+    int64_t days = days_from_civil(num(0, 4), static_cast<unsigned>(num(5, 2)), static_cast<unsigned>(num(8, 2)));
+    int64_t seconds = days * SECONDS_PER_DAY + num(11, 2) * 3600 + num(14, 2) * 60 + num(17, 2);
+
+    int64_t nanos = 0;
+    int digits = 0;
+    if (s.size() > 19 && s[19] == '.') {
+        for (size_t i = 20; i < s.size() && s[i] >= '0' && s[i] <= '9'; i++) {
+            if (digits < 9) {
+                nanos = nanos * 10 + (s[i] - '0');
+                digits++;
+            }
+        }
+    }
+    for (; digits < 9; digits++) nanos *= 10;
+
+    return seconds * NANOS_PER_SECOND + nanos;
+}
+
+// writes TIMESTAMP_TEXT_SIZE bytes, returns the end
+inline char *format_timestamp(char *out, int64_t ts) {
+    int64_t seconds = ts / NANOS_PER_SECOND;
+    int64_t nanos = ts % NANOS_PER_SECOND;
+    if (nanos < 0) {
+        nanos += NANOS_PER_SECOND;
+        seconds--;
+    }
+    int64_t days = seconds / SECONDS_PER_DAY;
+    int64_t secs_of_day = seconds % SECONDS_PER_DAY;
+    if (secs_of_day < 0) {
+        secs_of_day += SECONDS_PER_DAY;
+        days--;
+    }
+
+    int64_t y;
+    unsigned m, d;
+    civil_from_days(days, y, m, d);
+
+    auto put = [&](int64_t value, int width) {
+        for (int i = width - 1; i >= 0; i--) {
+            out[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        out += width;
+    };
+
+    put(y, 4);
+    *out++ = '-';
+    put(m, 2);
+    *out++ = '-';
+    put(d, 2);
+    *out++ = 'T';
+    put(secs_of_day / 3600, 2);
+    *out++ = ':';
+    put(secs_of_day / 60 % 60, 2);
+    *out++ = ':';
+    put(secs_of_day % 60, 2);
+    *out++ = '.';
+    put(nanos, 9);
+    *out++ = 'Z';
+    return out;
+}
+
+// two ascii digits per entry, "00".."99"
+inline constexpr char TWO_DIGITS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// 8 ascii digits -> value, all in one 64-bit register (little-endian)
+inline uint32_t parse_8_digits(const char *p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    v -= 0x3030303030303030;
+    v = v * 10 + (v >> 8);
+    v = ((v & 0x000000FF000000FF) * (100 + (1000000ULL << 32)) +
+         ((v >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32))) >> 32;
+    return static_cast<uint32_t>(v);
+}
+
+inline int parse_2_digits(const char *p) { return (p[0] - '0') * 10 + (p[1] - '0'); }
+
+// p holds TIMESTAMP_TEXT_SIZE bytes shaped "YYYY-MM-DDTHH:MM:SS.nnnnnnnnnZ"
+inline bool is_exact_timestamp(const char *p) {
+#ifdef __SSE2__
+    // bytes 0..15 and 14..29; separators must match, everything else be a digit
+    static const char shape[] = "0000-00-00T00:0000:00.000000000Z";
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 14));
+    __m128i shape_lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(shape));
+    __m128i shape_hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(shape + 16));
+    __m128i zero = _mm_set1_epi8('0');
+    __m128i nine = _mm_set1_epi8(9);
+
+    auto ok = [&](__m128i text, __m128i expect) {
+        __m128i digit_slot = _mm_cmpeq_epi8(expect, zero);
+        __m128i is_digit = _mm_cmpeq_epi8(_mm_subs_epu8(_mm_sub_epi8(text, zero), nine), _mm_setzero_si128());
+        __m128i is_same = _mm_cmpeq_epi8(text, expect);
+        return _mm_movemask_epi8(_mm_or_si128(_mm_and_si128(digit_slot, is_digit),
+                                              _mm_andnot_si128(digit_slot, is_same))) == 0xFFFF;
+    };
+    return ok(lo, shape_lo) && ok(hi, shape_hi);
+#else
+    static const char shape[] = "0000-00-00T00:00:00.000000000Z";
+    for (int i = 0; i < TIMESTAMP_TEXT_SIZE; i++) {
+        bool ok = shape[i] == '0' ? (p[i] >= '0' && p[i] <= '9') : p[i] == shape[i];
+        if (!ok) return false;
+    }
+    return true;
+#endif
+}
+
+// Feed timestamps: the exact 30-byte form is checked with one SIMD compare and
+// decoded with SWAR digit math; the date -> days step is cached per thread,
+// as consecutive rows nearly always share their date. Other text goes
+// through parse_timestamp_generic.
+inline int64_t parse_timestamp(std::string_view s) {
+    if (s.size() != TIMESTAMP_TEXT_SIZE || !is_exact_timestamp(s.data())) {
+        return parse_timestamp_generic(s);
+    }
+
+    const char *p = s.data();
+    thread_local char cached_date[10] = {};
+    thread_local int64_t cached_day_ns = 0;
+    if (std::memcmp(p, cached_date, 10) != 0) {
+        int year = parse_2_digits(p) * 100 + parse_2_digits(p + 2);
+        int64_t days = days_from_civil(year, static_cast<unsigned>(parse_2_digits(p + 5)),
+                                       static_cast<unsigned>(parse_2_digits(p + 8)));
+        std::memcpy(cached_date, p, 10);
+        cached_day_ns = days * SECONDS_PER_DAY * NANOS_PER_SECOND;
+    }
+
+    int64_t secs_of_day = parse_2_digits(p + 11) * 3600 + parse_2_digits(p + 14) * 60 + parse_2_digits(p + 17);
+    int64_t nanos = static_cast<int64_t>(parse_8_digits(p + 20)) * 10 + (p[28] - '0');
+    return cached_day_ns + secs_of_day * NANOS_PER_SECOND + nanos;
+}
+
+// format_timestamp for a run of nearby timestamps: keeps the rendered
+// "YYYY-MM-DDTHH:" of the current hour and "MM:SS." of the current second,
+// so most calls only render the nine fraction digits.
+class TimestampFormatter {
+public:
+    // writes TIMESTAMP_TEXT_SIZE bytes, returns the end
+    char *format(char *out, int64_t ts) {
+        int64_t second = ts / NANOS_PER_SECOND;
+        int64_t nanos = ts % NANOS_PER_SECOND;
+        if (nanos < 0) {
+            nanos += NANOS_PER_SECOND;
+            second--;
+        }
+
+        if (second != cached_second) {
+            if (!have_hour || second < hour_start || second >= hour_start + 3600) {
+                char full[TIMESTAMP_TEXT_SIZE];
+                format_timestamp(full, second * NANOS_PER_SECOND);
+                std::memcpy(text, full, 20);
+                hour_start = second - (parse_2_digits(full + 14) * 60 + parse_2_digits(full + 17));
+                have_hour = true;
+            }
+            int64_t in_hour = second - hour_start;
+            std::memcpy(text + 14, TWO_DIGITS + 2 * (in_hour / 60), 2);
+            std::memcpy(text + 17, TWO_DIGITS + 2 * (in_hour % 60), 2);
+            cached_second = second;
+        }
+
+        std::memcpy(out, text, 20);
+        uint32_t frac = static_cast<uint32_t>(nanos);
+        out[20] = static_cast<char>('0' + frac / 100000000);
+        frac %= 100000000;
+        for (int i = 27; i >= 21; i -= 2) {
+            std::memcpy(out + i, TWO_DIGITS + 2 * (frac % 100), 2);
+            frac /= 100;
+        }
+        out[29] = 'Z';
+        return out + TIMESTAMP_TEXT_SIZE;
+    }
+
+private:
+    char text[20] = {};     // "YYYY-MM-DDTHH:MM:SS."
+    bool have_hour = false;
+    int64_t hour_start = 0; // first second of the hour in text
+    int64_t cached_second = INT64_MIN;
+};
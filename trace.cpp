@@ -0,0 +1,86 @@
+#include "trace.h"
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+bool trace_active = false;
+thread_local TraceRing *trace_thread_ring = nullptr;
+
+// rings of every thread that recorded, created under the mutex (once per
+// thread), appended to without it
+static std::mutex trace_mutex;
+static std::vector<std::unique_ptr<TraceRing>> trace_rings;
+static std::string trace_path;
+static uint64_t trace_capacity = TRACE_DEFAULT_RECORDS;
+
+TraceRing::TraceRing(const std::string &path, uint64_t capacity, uint32_t thread_index) {
+    length = sizeof(TraceFileHeader) + capacity * sizeof(TraceRecord);
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    // sparse until written
+    if (::ftruncate(fd, static_cast<off_t>(length)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot size " + path);
+    }
+    base = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("cannot mmap " + path);
+    }
+
+    header = static_cast<TraceFileHeader *>(base);
+    records = reinterpret_cast<TraceRecord *>(static_cast<char *>(base) + sizeof(TraceFileHeader));
+    mask = capacity - 1;
+
+    std::memcpy(header->magic, TRACE_MAGIC, sizeof(header->magic));
+    header->version = TRACE_VERSION;
+    header->record_size = sizeof(TraceRecord);
+    header->capacity = capacity;
+    header->head = 0;
+    header->thread_index = thread_index;
+    header->price_scale_digits = PRICE_SCALE_DIGITS;
+}
+
+TraceRing::~TraceRing() {
+    ::munmap(base, length);
+    // a ring that never wrapped is cut back to the records it holds
+    if (written < mask + 1) {
+        ::ftruncate(fd, static_cast<off_t>(sizeof(TraceFileHeader) + written * sizeof(TraceRecord)));
+    }
+    ::close(fd);
+}
+
+void trace_open(const std::string &path, uint64_t capacity) {
+    uint64_t rounded = 1;
+    while (rounded < capacity) rounded <<= 1;
+
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    trace_path = path;
+    trace_capacity = rounded;
+    trace_active = true;
+}
+
+void trace_close() {
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    trace_active = false;
+    trace_thread_ring = nullptr;
+    trace_rings.clear();
+}
+
+TraceRing *trace_attach_thread() {
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    uint32_t index = static_cast<uint32_t>(trace_rings.size());
+    std::string path = index == 0 ? trace_path : trace_path + "." + std::to_string(index);
+    trace_rings.push_back(std::make_unique<TraceRing>(path, trace_capacity, index));
+    return trace_rings.back().get();
+}
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "book_types.h"
+#include "mbo_parser.h"
+#include "mbp_snapshot.h"
+
+// Event tracer, compiled into every build and switched on at run time
+// (`--trace <path>`). Each thread that records gets its own ring of fixed
+// 64-byte TraceRecords in a file mapped with MAP_SHARED: appends are plain
+// stores by the one writing thread, no locks and no system calls, and the
+// records reach the file even if the process dies. Once full the ring wraps
+// and keeps the newest `capacity` records. The first thread writes to
+// <path>, later ones to <path>.1, <path>.2, ... mbo_trace renders a file as
+// the logs.txt / mbp_logs.txt text the iostream debug logging used to write.
+//
+// Not tracing costs one branch per call site.
+
+constexpr char TRACE_MAGIC[8] = { 'M', 'B', 'P', 'T', 'R', 'C', '0', '1' };
+constexpr uint32_t TRACE_VERSION = 1;
+constexpr uint64_t TRACE_DEFAULT_RECORDS = 1 << 20; // 64 MiB per thread
+
+enum class TraceType : uint8_t {
+    TopOfBook = 1, // best bid / ask before a record is applied
+    Add,           // order added
+    Cancel,        // order cancelled
+    Tfc,           // F-C pair of a T-F-C sweep resolved into its cancel
+    EofPending,    // row still held for T-F-C matching at end of input
+    MissedTop,     // row touched a top-N price without a book change
+    Snapshot,      // MBP row emitted, followed by its Level records
+    Level,         // one level (bid and ask) of the preceding Snapshot
+};
+
+// bits of TraceRecord::flags
+constexpr uint8_t TRACE_BID = 1; // bid half (price/size/count) is set
+constexpr uint8_t TRACE_ASK = 2; // ask half (price2/size2/count2) is set
+
+// Field use by type:
+//   TopOfBook   price/count best bid, price2/count2 best ask
+//   Add/Cancel  order_id, side, price, size
+//   Tfc         side of the trade, order_id of the cancel
+//   EofPending  action, order_id
+//   MissedTop   price, row, depth = book depth
+//   Snapshot    row, action, side, depth, price, size, order_id,
+//               count / count2 live bid / ask levels, size2 book depth
+//   Level       depth = level index, bid and ask halves per flags
+struct TraceRecord {
+    uint8_t type;
+    char action;
+    char side;
+    uint8_t flags;
+    int32_t depth;
+    int64_t ts_event;
+    uint64_t order_id;
+    int64_t price;
+    int32_t size;
+    int32_t count;
+    int64_t price2;
+    int32_t size2;
+    int32_t count2;
+    int32_t row;
+    uint32_t reserved;
+};
+static_assert(sizeof(TraceRecord) == 64, "TraceRecord layout");
+
+struct TraceFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;      // records in the ring, a power of two
+    uint64_t head;          // records ever appended; the newest is at (head - 1) % capacity
+    uint32_t thread_index;  // 0 for <path>, n for <path>.n
+    int32_t price_scale_digits;
+    char reserved[24];
+};
+static_assert(sizeof(TraceFileHeader) == 64, "TraceFileHeader layout");
+
+// One thread's ring. Throws std::runtime_error if the file cannot be set up.
+class TraceRing {
+public:
+    TraceRing(const std::string &path, uint64_t capacity, uint32_t thread_index);
+    ~TraceRing();
+
+    TraceRing(const TraceRing &) = delete;
+    TraceRing &operator=(const TraceRing &) = delete;
+
+    void append(const TraceRecord &rec) {
+        records[written & mask] = rec;
+        written++;
+        // readers of a live or crashed process see whole records only
+        __atomic_store_n(&header->head, written, __ATOMIC_RELEASE);
+    }
+
+private:
+    int fd = -1;
+    void *base = nullptr;
+    size_t length = 0;
+    TraceFileHeader *header = nullptr;
+    TraceRecord *records = nullptr;
+    uint64_t mask = 0;
+    uint64_t written = 0;
+};
+
+// Starts tracing to path (capacity rounded up to a power of two). Call once
+// before any thread records; trace_close() unmaps every ring at exit.
+void trace_open(const std::string &path, uint64_t capacity = TRACE_DEFAULT_RECORDS);
+void trace_close();
+
+extern bool trace_active;
+extern thread_local TraceRing *trace_thread_ring;
+
+// creates the calling thread's ring
+TraceRing *trace_attach_thread();
+
+// the calling thread's ring, nullptr when not tracing
+inline TraceRing *trace_ring() {
+    if (!trace_active) return nullptr;
+    if (!trace_thread_ring) trace_thread_ring = trace_attach_thread();
+    return trace_thread_ring;
+}
+
+// CALL SITES
+template<typename BidSide, typename AskSide>
+inline void trace_top_of_book(const BidSide &bids, const AskSide &asks, const MboRecord &rec) {
+    TraceRing *ring = trace_ring();
+    if (!ring) return;
+
+    TraceRecord t = {};
+    t.type = static_cast<uint8_t>(TraceType::TopOfBook);
+    t.ts_event = rec.ts_event;
+    bids.for_each_level(1, [&](Price price, const PriceLevel &level) {
+        t.flags |= TRACE_BID;
+        t.price = price;
+        t.count = level.order_count;
+    });
+    asks.for_each_level(1, [&](Price price, const PriceLevel &level) {
+        t.flags |= TRACE_ASK;
+        t.price2 = price;
+        t.count2 = level.order_count;
+    });
+    ring->append(t);
+}
+
+inline void trace_order(TraceType type, const MboRecord &rec) {
+    TraceRing *ring = trace_ring();
+    if (!ring) return;
+
+    TraceRecord t = {};
+    t.type = static_cast<uint8_t>(type);
+    t.action = rec.action;
+    t.side = rec.side;
+    t.ts_event = rec.ts_event;
+    t.order_id = rec.order_id;
+    t.price = rec.price;
+    t.size = rec.size;
+    ring->append(t);
+}
+
+inline void trace_tfc(char trade_side, const MboRecord &cancel_row) {
+    TraceRing *ring = trace_ring();
+    if (!ring) return;
+
+    TraceRecord t = {};
+    t.type = static_cast<uint8_t>(TraceType::Tfc);
+    t.action = cancel_row.action;
+    t.side = trade_side;
+    t.ts_event = cancel_row.ts_event;
+    t.order_id = cancel_row.order_id;
+    t.price = cancel_row.price;
+    t.size = cancel_row.size;
+    ring->append(t);
+}
+
+inline void trace_eof_pending(const MboRecord &rec) {
+    TraceRing *ring = trace_ring();
+    if (!ring) return;
+
+    TraceRecord t = {};
+    t.type = static_cast<uint8_t>(TraceType::EofPending);
+    t.action = rec.action;
+    t.side = rec.side;
+    t.ts_event = rec.ts_event;
+    t.order_id = rec.order_id;
+    ring->append(t);
+}
+
+inline void trace_missed_top(const MboRecord &rec, int row_index, int book_depth) {
+    TraceRing *ring = trace_ring();
+    if (!ring) return;
+
+    TraceRecord t = {};
+    t.type = static_cast<uint8_t>(TraceType::MissedTop);
+    t.action = rec.action;
+    t.side = rec.side;
+    t.ts_event = rec.ts_event;
+    t.order_id = rec.order_id;
+    t.depth = book_depth;
+    t.price = rec.price;
+    t.row = row_index;
+    ring->append(t);
+}
+
+// a Snapshot record, then one Level record per row of live levels
+template<int Depth>
+inline void trace_snapshot(const MbpSnapshot<Depth> &snap) {
+    TraceRing *ring = trace_ring();
+    if (!ring) return;
+
+    TraceRecord t = {};
+    t.type = static_cast<uint8_t>(TraceType::Snapshot);
+    t.action = snap.action;
+    t.side = snap.side;
+    t.depth = snap.depth;
+    t.ts_event = snap.rec->ts_event;
+    t.order_id = snap.order_id;
+    t.price = snap.price;
+    t.size = snap.size;
+    t.count = snap.bid_count;
+    t.count2 = snap.ask_count;
+    t.size2 = Depth;
+    t.row = snap.row_index;
+    ring->append(t);
+
+    int levels = snap.bid_count > snap.ask_count ? snap.bid_count : snap.ask_count;
+    for (int i = 0; i < levels; i++) {
+        TraceRecord l = {};
+        l.type = static_cast<uint8_t>(TraceType::Level);
+        l.depth = i;
+        l.ts_event = t.ts_event;
+        l.row = t.row;
+        if (i < snap.bid_count) {
+            l.flags |= TRACE_BID;
+            l.price = snap.bids[i].px;
+            l.size = snap.bids[i].sz;
+            l.count = snap.bids[i].ct;
+        }
+        if (i < snap.ask_count) {
+            l.flags |= TRACE_ASK;
+            l.price2 = snap.asks[i].px;
+            l.size2 = snap.asks[i].sz;
+            l.count2 = snap.asks[i].ct;
+        }
+        ring->append(l);
+    }
+}